@@ -0,0 +1,1728 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name: Chip 8 Interpreter
+//
+// Author: Jonathan Del Corpo
+// Contact: jonathan_delcorpo@hotmail.com
+//
+// License: GNU General Public License (GPL) v2 
+// ( http://www.gnu.org/licenses/old-licenses/gpl-2.0.html )
+//
+///////////////////////////////////////////////////////////////////////////////
+#include <algorithm>
+#include "Chip8.h"
+#include "RomCache.h"
+#include "Jit.h"
+
+// Pages of memory that were never written, shared by every instance
+static const unsigned char ZERO_PAGE[Chip8::PAGE_SIZE] = {};
+
+Chip8::Chip8() : core(CORE_TABLE), codePages(0), dirtyPages(0), writtenPages(0),
+	stopOn(STOP_NONE), stopReason(RUN_DONE), cycleCount(0), cyclesPerFrame(DEFAULT_CYCLES_PER_FRAME),
+	frameCycle(0), idleSkipping(true), idleCycles(0), keyWait(false), randomState(1), screenEdge(EDGE_CLIP), dirtyRows(0)
+{
+	loadOpcodeTable();
+	clearMemory();
+}
+
+Chip8::~Chip8() {}
+
+void Chip8::initialize()
+{
+	// Initialize registers and memory once
+
+	pc = 0x200;	// Program counter starts at 0x200
+	opcode = 0;		// Reset current opcode
+	I = 0;		// Reset index register
+	sp = 0;		// Reset stack pointer
+
+				// Clear display, the frontend must draw all of it
+	memset(gfx, 0, sizeof(gfx));
+	dirtyRows = ALL_SCREEN_ROWS;
+
+	// Clear stack
+	for (int i = 0; i < 16; ++i)
+		stack[i] = 0;
+
+	// Clear keys  and registers
+	for (int i = 0; i < 16; ++i)
+		key[i] = V[i] = 0;
+
+	clearMemory();
+
+	clearDecodeCache();
+
+	// Reset timers
+	delay_timer = 0;
+	sound_timer = 0;
+
+	cycleCount = 0;
+	frameCycle = 0;
+	idleCycles = 0;
+	keyWait = false;
+
+#if CHIP8_TRACE_LEVEL >= 1
+	trace.clear();
+#endif
+
+	setSeed((unsigned int)time(NULL));
+}
+
+const Chip8::OpcodeHandler Chip8::handlers[OP_COUNT] =
+{
+	&Chip8::UNKNOWN,
+	&Chip8::CLS, &Chip8::RET, &Chip8::JP, &Chip8::CALL, &Chip8::SE, &Chip8::SNE, &Chip8::SE2, &Chip8::LD, &Chip8::ADD,
+	&Chip8::LD2, &Chip8::OR, &Chip8::AND, &Chip8::XOR, &Chip8::ADD2, &Chip8::SUB, &Chip8::SHR, &Chip8::SUBN, &Chip8::SHL,
+	&Chip8::SNE2, &Chip8::LD3, &Chip8::JP2, &Chip8::RND, &Chip8::DRW, &Chip8::SKP, &Chip8::SKNP,
+	&Chip8::LD4, &Chip8::LD5, &Chip8::LD6, &Chip8::LD7, &Chip8::ADD3, &Chip8::LD8, &Chip8::LD9, &Chip8::LD10, &Chip8::LD11
+};
+
+unsigned char Chip8::opcodeTable[0x10000];
+
+const unsigned char Chip8::chip8_fontset[80] =
+{
+	0xF0, 0x90, 0x90, 0x90, 0xF0, // 0
+	0x20, 0x60, 0x20, 0x20, 0x70, // 1
+	0xF0, 0x10, 0xF0, 0x80, 0xF0, // 2
+	0xF0, 0x10, 0xF0, 0x10, 0xF0, // 3
+	0x90, 0x90, 0xF0, 0x10, 0x10, // 4
+	0xF0, 0x80, 0xF0, 0x10, 0xF0, // 5
+	0xF0, 0x80, 0xF0, 0x90, 0xF0, // 6
+	0xF0, 0x10, 0x20, 0x40, 0x40, // 7
+	0xF0, 0x90, 0xF0, 0x90, 0xF0, // 8
+	0xF0, 0x90, 0xF0, 0x10, 0xF0, // 9
+	0xF0, 0x90, 0xF0, 0x90, 0x90, // A
+	0xE0, 0x90, 0xE0, 0x90, 0xE0, // B
+	0xF0, 0x80, 0x80, 0x80, 0xF0, // C
+	0xE0, 0x90, 0x90, 0x90, 0xE0, // D
+	0xF0, 0x80, 0xF0, 0x80, 0xF0, // E
+	0xF0, 0x80, 0xF0, 0x80, 0x80  // F
+};
+
+// Fontset at the start of the first page, shared by every instance like ZERO_PAGE
+const unsigned char *Chip8::fontPage()
+{
+	static unsigned char page[PAGE_SIZE];
+	static bool loaded = (memcpy(page, chip8_fontset, sizeof(chip8_fontset)), true);
+	(void)loaded;
+	return page;
+}
+
+// The opcode table is shared by every instance and only built once
+void Chip8::loadOpcodeTable()
+{
+	static bool tableBuilt = buildOpcodeTable();
+	(void)tableBuilt;
+}
+
+// Decode every possible opcode once so executeCycle only needs a table lookup
+bool Chip8::buildOpcodeTable()
+{
+	for (int i = 0; i < 0x10000; ++i)
+		opcodeTable[i] = decode((unsigned short)i);
+
+	return true;
+}
+
+// For opcodes:
+// https://en.wikipedia.org/wiki/CHIP-8#Opcode_table
+// http://devernay.free.fr/hacks/chip8/C8TECH10.HTM#00E0
+unsigned char Chip8::decode(unsigned short opcode)
+{
+	switch (opcode & 0xF000) // first 4 bits of the opcode
+	{
+		// Some opcodes
+
+		// If first 4 bits start with 0
+		// For 0x0XXX there are 2 opcodes
+	case 0x0000:
+
+		// Last 4 bits
+		switch (opcode & 0x000F)
+		{
+			// 0x00E0: Clears the screen - CLS
+		case 0x0000:
+			return OP_CLS;
+
+			// 0x00EE: Returns from subroutine - RET
+		case 0x000E:
+			return OP_RET;
+
+		default:
+			return OP_UNKNOWN;
+		}
+
+		// For 0x1XXX there is 1 opcode
+		// 0x1NNN jumps to memory location nnn
+	case 0x1000:
+		return OP_JP;
+
+		// For 0x2XXX there is 1 opcode
+		// 0x2NNN - calls subroutine at address NNN - CALL
+	case 0x2000:
+		return OP_CALL;
+
+		// For 0x3XXX there is 1 opcode
+		// 0x3XNN - skips next instruction if VX is equal to NN
+	case 0x3000:
+		return OP_SE;
+
+		// For 0x4XXX there is 1 opcode
+		// 0x4XNN - skips next instruction if VX is not equal to NN
+	case 0x4000:
+		return OP_SNE;
+
+		// For 0x5XXX there is 1 opcode
+		// 0x5XY0 - skips next instruction if VX and VY are equal
+	case 0x5000:
+		return OP_SE2;
+
+		// For 0x6XXX there is 1 opcode
+		// 0x6XNN - set VX to NN
+	case 0x6000:
+		return OP_LD;
+
+		// For 0x7XXX there is 1 opcode
+		// 0x7XNN - add NN to VX
+	case 0x7000:
+		return OP_ADD;
+
+		// For 0x8XXX there are 9 opcodes
+	case 0x8000: // 0x8XY[0-E] cpu rewgister manipulation opcodes
+		switch (opcode & 0x000F)
+		{
+			// 8xy0 - Set VX to VY - LD
+		case 0x0000:
+			return OP_LD2;
+
+			// 8xy1 - Set VX to VX or VY - OR
+		case 0x0001:
+			return OP_OR;
+
+			// 8xy2 - Set VX to VX and VY - AND
+		case 0x0002:
+			return OP_AND;
+
+			// 8xy2 - Set VX to VX xor VY - XOR
+		case 0x0003:
+			return OP_XOR;
+
+			// Adds VY to VX - ADD
+			// 8xy4 - Set VF to 1 for carry (if sum is larger than 255 or 0xF0) 0 when there isn't
+		case 0x0004:
+			return OP_ADD2;
+
+			// Substracts VY from VX - SUB
+			// 8xy5 - Set VF to 1 for borrow (if subraction is less than 0 or 0x00) 0 when there isn't
+		case 0x0005:
+			return OP_SUB;
+
+			// Shift  VX right by 1 - SHR
+			// 8xy6 - VF is set to the value of the least significant bit of VX before the shift
+		case 0x0006:
+			return OP_SHR;
+
+			// 8xy7 - Subtracts VX from VY and stores the result in VX - SUBN
+		case 0x0007:
+			return OP_SUBN;
+
+			// Shift  VX left by 1 - SHL
+			// VF is set to the value of the least significant bit of VX before the shift
+		case 0x000E:
+			return OP_SHL;
+
+		default:
+			return OP_UNKNOWN;
+		}
+
+		// For 0x9XXX there is 1 opcode
+		// 0x9XY0 - skip to next instruction if VX is not equal to VY
+	case 0x9000:
+		return OP_SNE2;
+
+		// For 0xAXXX there is 1 opcode
+		// 0xANNN - Sets I to the address NNN (Last 12 bits)
+	case 0xA000:
+		return OP_LD3;
+
+		// For 0xBXXX there is 1 opcode
+		// 0xBNNN - Jump to location NNN + V0
+	case 0xB000:
+		return OP_JP2;
+
+		// For 0xCXXX there is 1 opcode
+		// Cxnn - Set Vx equal to random byte AND nn.
+	case 0xC000:
+		return OP_RND;
+
+		// For 0xDXXX there is 1 opcode
+		// 0xDXYN - Display n-byte sprite starting at memory location I at (Vx, Vy), set VF = collision.
+	case 0xD000:
+		return OP_DRW;
+
+		// For 0xEXXX there are 2 opcodes
+	case 0xE000:
+		switch (opcode & 0x00FF)
+		{
+			// 0xEX9E - skip to next instruction if key with the value VX is pressed
+		case 0x009E:
+			return OP_SKP;
+
+			// 0xA1 - Skip next instruction if key with the value of Vx is not pressed.
+		case 0x00A1:
+			return OP_SKNP;
+
+		default:
+			return OP_UNKNOWN;
+		}
+
+		//For 0xFXXX there are 9 opcodes
+	case 0xF000:
+		switch (opcode & 0x00FF)
+		{
+			// 0xFX07 - Set VX to delay timer value
+		case 0x0007:
+			return OP_LD4;
+
+			// 0xFX0A - Wait for a key press, store the value of the key in VX
+		case 0x000A:
+			return OP_LD5;
+
+			// 0xFX15 - Set delay timer to VX
+		case 0x0015:
+			return OP_LD6;
+
+			// 0xFX18 - set sound timer equal to VX
+		case 0x0018:
+			return OP_LD7;
+
+			// 0xFX1E - Add I to VX and store in I
+		case 0x001E:
+			return OP_ADD3;
+
+			// 0xFX29 - Set I to location of sprite for digit VX
+		case 0x0029:
+			return OP_LD8;
+
+			// 0xFX33 - Store BCD representation of Vx in memory locations I, I + 1, and I + 2.
+		case 0x0033:
+			return OP_LD9;
+
+			// 0xFX55 - Store registers V0 through VX in memory starting at location I
+		case 0x0055:
+			return OP_LD10;
+
+			// 0xFX65 - Read registers V0 through Vx from memory starting at location I.
+		case 0x0065:
+			return OP_LD11;
+
+		default:
+			return OP_UNKNOWN;
+		}
+
+	default:
+		return OP_UNKNOWN;
+	}
+
+}
+
+// Extract the operands of the opcode, every opcode function reads them from here
+void Chip8::decodeInstruction(unsigned short opcode, unsigned char operation, Instruction& ins)
+{
+	ins.opcode = opcode;
+	ins.operation = operation;
+	ins.X = (opcode & 0x0F00) >> 8;
+	ins.Y = (opcode & 0x00F0) >> 4;
+	ins.N = opcode & 0x000F;
+	ins.NN = opcode & 0x00FF;
+	ins.NNN = opcode & 0x0FFF;
+}
+
+void Chip8::executeCycle()
+{
+	// Fetch Opcode
+	opcode = fetch(pc);
+
+	CHIP8_TRACE(trace, pc, opcode, cycleCount);
+
+	// Decode and Execute Opcode
+	// The block cores run single opcodes from the decode cache too
+	if (core != CORE_SWITCH && core != CORE_TABLE)
+	{
+		// Decoded once the first time the address is executed
+		Instruction& ins = decodeCache[pc & 0xFFF];
+		if (!ins.cached)
+		{
+			decodeInstruction(opcode, opcodeTable[opcode], ins);
+			ins.cached = true;
+		}
+
+		(this->*handlers[ins.operation])(ins);
+	}
+	else
+	{
+		Instruction ins;
+		if (core == CORE_SWITCH)
+			decodeInstruction(opcode, decode(opcode), ins);
+		else
+			decodeInstruction(opcode, opcodeTable[opcode], ins);
+
+		(this->*handlers[ins.operation])(ins);
+	}
+
+	endCycle();
+
+	//system("pause");
+}
+
+// Run decoded blocks until the number of cycles is executed, returns the number of cycles executed
+// Each block remembers the blocks that followed it so jumps between hot blocks skip the lookup
+unsigned long long Chip8::runBlocks(unsigned long long cycles)
+{
+	if (blocks.empty())
+		blocks.resize(4096);
+
+	unsigned long long executed = 0;
+	Block *block = NULL;
+
+	// Opcodes that stop the run end their block
+	while (executed < cycles && stopReason == RUN_DONE)
+	{
+		// Memory holding decoded opcodes was written
+		if (dirtyPages != 0)
+			invalidateBlocks(dirtyPages);
+
+		unsigned short address = pc & 0xFFF;
+		Block *next = NULL;
+
+		// Follow the chain first
+		if (block != NULL)
+		{
+			if (block->next[0] != NULL && block->next[0]->valid && block->next[0]->start == address)
+				next = block->next[0];
+			else if (block->next[1] != NULL && block->next[1]->valid && block->next[1]->start == address)
+				next = block->next[1];
+		}
+
+		if (next == NULL)
+		{
+			next = &blocks[address];
+			if (!next->valid)
+				next = compileBlock(address);
+
+			if (block != NULL)
+			{
+				block->next[1] = block->next[0];
+				block->next[0] = next;
+			}
+		}
+
+		block = next;
+
+		// The last block may only be partially executed
+		size_t length = block->ops.size();
+		if (length > cycles - executed)
+			length = (size_t)(cycles - executed);
+
+		for (size_t i = 0; i < length; ++i)
+		{
+			const Instruction& ins = block->ops[i];
+			opcode = ins.opcode;
+			CHIP8_TRACE(trace, pc, opcode, cycleCount);
+			(this->*handlers[ins.operation])(ins);
+			endCycle();
+		}
+
+		executed += length;
+	}
+
+	return executed;
+}
+
+// Run compiled blocks until the number of cycles is executed, returns the number of cycles executed
+// Compiled code jumps from block to block on its own and comes back here for the opcodes it leaves to the
+// interpreter and for addresses that aren't compiled. Blocks are compiled once they ran a few times so code
+// that is rewritten as it runs stays in the interpreter instead of being compiled over and over.
+unsigned long long Chip8::runJit(unsigned long long cycles)
+{
+#if CHIP8_TRACE_LEVEL >= 1
+	// Every opcode is traced, compiled code can't
+	return runBlocks(cycles);
+#else
+	const unsigned int HOT_BLOCK_RUNS = 8;
+
+	if (!jit)
+		jit.reset(new Jit(*this));
+
+	if (!jit->available())
+		return runBlocks(cycles);
+
+	if (blocks.empty())
+		blocks.resize(4096);
+
+	unsigned long long executed = 0;
+
+	while (executed < cycles && stopReason == RUN_DONE)
+	{
+		// Memory holding decoded opcodes was written
+		if (dirtyPages != 0)
+			invalidateBlocks(dirtyPages);
+
+		unsigned short address = pc & 0xFFF;
+		Block *block = &blocks[address];
+		if (!block->valid)
+			block = compileBlock(address);
+
+		if (block->runs < HOT_BLOCK_RUNS && ++block->runs == HOT_BLOCK_RUNS)
+			jitBlock(*block);
+
+		// Compiled code is only entered at the address it was compiled for
+		if (pc == address && jit->compiled(address))
+		{
+			unsigned long long ran = jit->run(*this, cycles - executed);
+			cycleCount += ran;
+			executed += ran;
+			if (ran != 0)
+				continue;
+		}
+
+		// The last block may only be partially executed
+		size_t length = block->ops.size();
+		if (length > cycles - executed)
+			length = (size_t)(cycles - executed);
+
+		for (size_t i = 0; i < length; ++i)
+		{
+			const Instruction& ins = block->ops[i];
+			opcode = ins.opcode;
+			(this->*handlers[ins.operation])(ins);
+			endCycle();
+		}
+
+		executed += length;
+	}
+
+	return executed;
+#endif
+}
+
+// Run opcodes on the selected core until the number of cycles is executed or one of the stopOn events happens
+Chip8::RunResult Chip8::run(unsigned long long cycles, unsigned int stopOn)
+{
+	this->stopOn = stopOn;
+	stopReason = RUN_DONE;
+
+	// JP and Fx0A stop the core with RUN_IDLE when the program is idle, the idle opcodes are skipped here
+	unsigned long long end = cycleCount + cycles;
+	while (cycleCount < end)
+	{
+		runCore(end - cycleCount);
+		if (stopReason != RUN_IDLE)
+			break;
+
+		stopReason = RUN_DONE;
+		skipIdle(end - cycleCount);
+	}
+
+	this->stopOn = STOP_NONE;
+	return stopReason;
+}
+
+unsigned long long Chip8::runCore(unsigned long long cycles)
+{
+	switch (core)
+	{
+	case CORE_BLOCK:
+		return runBlocks(cycles);
+
+	case CORE_JIT:
+		return runJit(cycles);
+
+	case CORE_STATIC:
+		return runStatic(cycles);
+
+	case CORE_THREADED:
+		return runThreaded(cycles);
+
+	default:
+		return runCycles(cycles);
+	}
+}
+
+// True when the address starts a loop polling the delay timer that can't end before the timer ticks:
+// Fx07 (Vx = DT), 3xnn or 4xnn testing Vx, 1nnn back to the Fx07
+bool Chip8::idleLoopAt(unsigned short address) const
+{
+	unsigned short load = readMemory(address) << 8 | readMemory(address + 1);
+	unsigned short test = readMemory(address + 2) << 8 | readMemory(address + 3);
+	unsigned short jump = readMemory(address + 4) << 8 | readMemory(address + 5);
+
+	if ((load & 0xF0FF) != 0xF007 || jump != (0x1000 | (address & 0xFFF)) || (test & 0x0F00) != (load & 0x0F00))
+		return false;
+
+	// Timers only change between frames, so the test gives the same result until the frame ends
+	switch (test & 0xF000)
+	{
+	case 0x3000:
+		return delay_timer != (test & 0xFF);
+
+	case 0x4000:
+		return delay_timer == (test & 0xFF);
+
+	default:
+		return false;
+	}
+}
+
+// Skip whole turns of the idle loop at the program counter, the core runs whatever is left
+void Chip8::skipIdle(unsigned long long cycles)
+{
+	unsigned short opcode = fetch(pc);
+	unsigned long long skipped;
+
+	if ((opcode & 0xF0FF) == 0xF00A)
+	{
+		// Keys don't change during run, Fx0A would run again for every cycle left
+		skipped = cycles;
+	}
+	else if (idleLoopAt(pc))
+	{
+		// A turn of the loop is 3 opcodes and leaves Vx = DT
+		skipped = cycles - cycles % 3;
+		if (skipped != 0)
+			V[(opcode & 0x0F00) >> 8] = delay_timer;
+	}
+	else
+	{
+		return;
+	}
+
+	cycleCount += skipped;
+	idleCycles += skipped;
+}
+
+// Run the rest of the opcodes of the current frame, the timers tick once it is complete
+// When run stops early the next call continues the same frame
+Chip8::RunResult Chip8::runFrame(unsigned int stopOn)
+{
+	unsigned long long start = cycleCount;
+	RunResult result = run(cyclesPerFrame - frameCycle, stopOn);
+	frameCycle += (unsigned int)(cycleCount - start);
+
+	if (frameCycle >= cyclesPerFrame)
+	{
+		frameCycle = 0;
+		tickTimers();
+	}
+
+	return result;
+}
+
+void Chip8::setCore(Core core)
+{
+	this->core = core;
+}
+
+void Chip8::setCyclesPerFrame(unsigned int cycles)
+{
+	cyclesPerFrame = cycles;
+	frameCycle = 0;
+}
+
+void Chip8::setScreenEdge(ScreenEdge edge)
+{
+	screenEdge = edge;
+}
+
+void Chip8::setSeed(unsigned int seed)
+{
+	// xorshift never leaves 0
+	randomState = seed != 0 ? seed : 0x2545F491;
+}
+
+// 32 bit xorshift, in the same 0 - 254 range rand() % 0xFF gave
+unsigned char Chip8::nextRandom()
+{
+	randomState ^= randomState << 13;
+	randomState ^= randomState >> 17;
+	randomState ^= randomState << 5;
+	return randomState % 0xFF;
+}
+
+void Chip8::setIdleSkipping(bool enabled)
+{
+	idleSkipping = enabled;
+}
+
+unsigned long long Chip8::getIdleCycleCount()
+{
+	return idleCycles;
+}
+
+bool Chip8::isWaitingForKey() const
+{
+	return keyWait && delay_timer == 0 && sound_timer == 0;
+}
+
+unsigned long long Chip8::getCycleCount()
+{
+	return cycleCount;
+}
+
+// Print the last opcodes executed
+void Chip8::dumpTrace(FILE *file)
+{
+#if CHIP8_TRACE_LEVEL >= 1
+	trace.dump(file);
+#else
+	fprintf(file, "Tracing is disabled, build with CHIP8_TRACE_LEVEL 1 or 2\n");
+#endif
+}
+
+void Chip8::writeTrace(int fd) const
+{
+#if CHIP8_TRACE_LEVEL >= 1
+	trace.writeDump(fd);
+#else
+	SignalSafeWriter out(fd);
+	out.text("Tracing is disabled, build with CHIP8_TRACE_LEVEL 1 or 2\n");
+#endif
+}
+
+// Run executeCycle until the number of cycles is executed, returns the number of cycles executed
+unsigned long long Chip8::runCycles(unsigned long long cycles)
+{
+	unsigned long long executed = 0;
+
+	while (executed < cycles && stopReason == RUN_DONE)
+	{
+		executeCycle();
+		++executed;
+	}
+
+	return executed;
+}
+
+Chip8::LoadResult Chip8::loadGame(const std::string& gamePath)
+{
+	unsigned char rom[MAX_ROM_SIZE];
+	size_t length;
+
+	LoadResult result = readRom(gamePath, rom, length);
+	if (result != LOAD_OK)
+		return result;
+
+	return loadGame(rom, length);
+}
+
+Chip8::LoadResult Chip8::loadGame(const unsigned char *rom, size_t length)
+{
+	if (length > MAX_ROM_SIZE)
+		return LOAD_TOO_BIG;
+
+	copyToMemory(ROM_START, rom, length);
+	romLoaded(rom, length);
+	return LOAD_OK;
+}
+
+Chip8::LoadResult Chip8::loadGame(const std::shared_ptr<const RomImage>& image)
+{
+	size_t length = image->bytes.size();
+	if (length > MAX_ROM_SIZE)
+		return LOAD_TOO_BIG;
+
+	// Pages of the image replace the pages of memory, the last one is only shared if the rest of it was zeros
+	unsigned int first = ROM_START / PAGE_SIZE;
+	for (size_t offset = 0; offset < length; offset += PAGE_SIZE)
+	{
+		unsigned int page = first + (unsigned int)(offset / PAGE_SIZE);
+		if (length - offset >= PAGE_SIZE || memoryPages[page] == ZERO_PAGE)
+		{
+			memoryPages[page] = &image->pages[offset];
+			privatePageMask &= ~(1 << page);
+		}
+		else
+		{
+			copyToMemory((unsigned short)(ROM_START + offset), &image->bytes[offset], length - offset);
+		}
+	}
+	romImage = image;
+
+	clearDecodeCache();
+	std::copy(image->decoded.begin(), image->decoded.end(), decodeCache + ROM_START);
+
+	loadStaticRom(image->hash, length);
+	return LOAD_OK;
+}
+
+Chip8::LoadResult Chip8::readRom(const std::string& gamePath, unsigned char *buffer, size_t& length)
+{
+	std::ifstream gameFile(gamePath, std::ios::in | std::ios::binary);
+	if (!gameFile)
+		return LOAD_NOT_FOUND;
+
+	gameFile.seekg(0, std::ios::end);
+	std::streamoff size = gameFile.tellg();
+	if (size < 0)
+		return LOAD_READ_ERROR;
+
+	if ((unsigned long long)size > MAX_ROM_SIZE)
+		return LOAD_TOO_BIG;
+
+	gameFile.seekg(0, std::ios::beg);
+	gameFile.read((char *)buffer, size);
+	if (gameFile.gcount() != size)
+		return LOAD_READ_ERROR;
+
+	length = (size_t)size;
+	return LOAD_OK;
+}
+
+const char *Chip8::describeLoadResult(LoadResult result)
+{
+	switch (result)
+	{
+	case LOAD_OK:
+		return "loaded";
+
+	case LOAD_NOT_FOUND:
+		return "can't open";
+
+	case LOAD_READ_ERROR:
+		return "can't read";
+
+	case LOAD_TOO_BIG:
+		return "too big";
+
+	default:
+		return "unknown error";
+	}
+}
+
+void Chip8::romLoaded(const unsigned char *rom, size_t length)
+{
+	clearDecodeCache();
+
+	loadStaticRom(hashRom(rom, length), length);
+}
+
+unsigned char Chip8::getPixel(unsigned int x, unsigned int y) const
+{
+	return getScreenPixel(gfx[y % SCREEN_HEIGHT], x % SCREEN_WIDTH);
+}
+
+void Chip8::expandScreen(unsigned char pixels[SCREEN_HEIGHT][SCREEN_WIDTH]) const
+{
+	for (unsigned int y = 0; y < SCREEN_HEIGHT; ++y)
+		for (unsigned int x = 0; x < SCREEN_WIDTH; ++x)
+			pixels[y][x] = getScreenPixel(gfx[y], x);
+}
+
+bool Chip8::getDrawFlag() const
+{
+	return dirtyRows != 0;
+}
+
+unsigned long long Chip8::takeDirtyRows()
+{
+	unsigned long long rows = dirtyRows;
+	dirtyRows = 0;
+	return rows;
+}
+
+unsigned long long Chip8::hashScreen() const
+{
+	return hashRom((const unsigned char *)gfx, sizeof(gfx));
+}
+
+unsigned char Chip8::getDelayTimer()
+{
+	return delay_timer;
+}
+
+// 64 bit FNV-1a hash, identifies a ROM image
+unsigned long long Chip8::hashRom(const unsigned char *bytes, size_t length)
+{
+	unsigned long long hash = 14695981039346656037ULL;
+	for (size_t i = 0; i < length; ++i)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+// ROMs recompiled by -recompile and linked into the program
+static std::vector<const StaticRom *>& staticRoms()
+{
+	static std::vector<const StaticRom *> roms;
+	return roms;
+}
+
+// Called by the recompiled code when the program starts
+bool Chip8::registerStaticRom(const StaticRom *rom)
+{
+	staticRoms().push_back(rom);
+	return true;
+}
+
+// Use the recompiled blocks of the ROM if it was recompiled
+void Chip8::loadStaticRom(unsigned long long hash, size_t size)
+{
+	staticBlocks.clear();
+
+	for (size_t i = 0; i < staticRoms().size(); ++i)
+	{
+		const StaticRom *rom = staticRoms()[i];
+		if (rom->hash != hash || rom->size != size)
+			continue;
+
+		staticBlocks.resize(4096, NULL);
+		for (size_t j = 0; j < rom->blockCount; ++j)
+			staticBlocks[rom->blocks[j].address & 0xFFF] = &rom->blocks[j];
+		return;
+	}
+}
+
+// 0nnn - SYS addr
+// Jump to a machine code routine at nnn.
+void Chip8::SYS(const Instruction&)
+{
+	// Ignored by modern interpreters
+}
+
+//00E0 - CLS
+//Clear the display.
+void Chip8::CLS(const Instruction&)
+{
+	// There are 2048 pixels
+	clearGFX();
+	movePC();
+
+	if (stopOn & STOP_ON_DRAW)
+		stopReason = RUN_DRAW;
+}
+
+
+
+//00EE - RET
+//Return from a subroutine.
+void Chip8::RET(const Instruction&)
+{
+	// Pop the stack, going to the previous value
+	--sp;
+
+	// Set the program counter to the previous memory location from the stack
+	pc = stack[sp];
+
+	// Move the program counter by 2 bytes
+	movePC();
+}
+
+//1nnn - JP addr
+//Jump to location nnn.
+void Chip8::JP(const Instruction& ins)
+{
+	pc = ins.NNN;
+
+	if (idleSkipping && idleLoopAt(pc))
+		stopReason = RUN_IDLE;
+}
+
+//2nnn - CALL addr
+//Call subroutine at nnn.
+void Chip8::CALL(const Instruction& ins)
+{
+	// Push the current program counter to the stack so that we can go back later
+	stack[sp] = pc;
+
+	// Move the stack pointer by 1 for the next program counter to be pushed onto it
+	++sp;
+
+	// set the current program counter to the memory location of the subroutine NNN
+	pc = ins.NNN;
+}
+
+//3xnn - SE Vx, byte
+//Skip next instruction if Vx = nn.
+void Chip8::SE(const Instruction& ins)
+{
+	if (V[ins.X] == ins.NN)
+		movePC();
+
+	movePC();
+}
+
+//4xnn - SNE Vx, byte
+//Skip next instruction if Vx != nn.
+void Chip8::SNE(const Instruction& ins)
+{
+	if (V[ins.X] != ins.NN)
+		movePC();
+
+	movePC();
+}
+
+//5xy0 - SE Vx, Vy
+//Skip next instruction if Vx = Vy.
+void Chip8::SE2(const Instruction& ins)
+{
+	if (V[ins.X] == V[ins.Y])
+		movePC();
+
+	movePC();
+}
+
+//6xnn - LD Vx, byte
+//Set Vx = nn.
+void Chip8::LD(const Instruction& ins)
+{
+	V[ins.X] = ins.NN;
+	movePC();
+}
+
+//7xnn - ADD Vx, byte
+//Set Vx = Vx + nn.
+void Chip8::ADD(const Instruction& ins)
+{
+	V[ins.X] += ins.NN;
+	movePC();
+}
+
+//8xy0 - LD Vx, Vy
+//Set Vx = Vy.
+void Chip8::LD2(const Instruction& ins)
+{
+	V[ins.X] = V[ins.Y];
+	movePC();
+}
+
+//8xy1 - OR Vx, Vy
+//Set Vx = Vx OR Vy
+void Chip8::OR(const Instruction& ins)
+{
+	V[ins.X] = V[ins.X] | V[ins.Y];
+	movePC();
+}
+
+//8xy2 - AND Vx, Vy
+//Set Vx = Vx AND Vy.
+void Chip8::AND(const Instruction& ins)
+{
+	V[ins.X] = V[ins.X] & V[ins.Y];
+	movePC();
+}
+
+//8xy3 - XOR Vx, Vy
+//Set Vx = Vx XOR Vy.
+void Chip8::XOR(const Instruction& ins)
+{
+	V[ins.X] = V[ins.X] ^ V[ins.Y];
+	movePC();
+}
+
+//8xy4 - ADD Vx, Vy
+//Set Vx = Vx + Vy, set VF = carry.
+void Chip8::ADD2(const Instruction& ins)
+{
+	// If the sum is larger than 255 set the carry flag for VF
+	if (V[ins.X] + V[ins.Y] > 0xF0)
+		V[0xF] = 1; // carry
+	else
+		V[0xF] = 0;
+
+	V[ins.X] += V[ins.Y];
+
+	movePC();
+}
+
+//8xy5 - SUB Vx, Vy
+//Set Vx = Vx - Vy, set VF = NOT borrow.
+void Chip8::SUB(const Instruction& ins)
+{
+	// If the subtraction is below 0 set the borrow flag for VF
+	if (V[ins.X] > V[ins.Y])
+		V[0xF] = 1; // borrow
+	else
+		V[0xF] = 0;
+
+	V[ins.X] -= V[ins.Y];
+
+	movePC();
+}
+
+//8xy6 - SHR Vx {, Vy}
+//Set Vx = Vx SHR 1.
+void Chip8::SHR(const Instruction& ins)
+{
+	//Get the least significant bit of VX and store it in VF to know whether the number is even or odd
+	V[0xF] = V[ins.X] % 0x2;
+
+	//Shift VX right by 1
+	V[ins.X] = V[ins.X] >> 0x1;
+
+	movePC();
+}
+
+//8xy7 - SUBN Vx, Vy
+//Set Vx = Vy - Vx, set VF = NOT borrow.
+void Chip8::SUBN(const Instruction& ins)
+{
+	if (V[ins.Y] > V[ins.X])
+		V[0xF] = 1; // borrow
+	else
+		V[0xF] = 0;
+
+	V[ins.X] = V[ins.Y] - V[ins.X];
+
+	movePC();
+}
+
+
+//8xyE - SHL Vx{ , Vy }
+//Set Vx = Vx SHL 1.
+void Chip8::SHL(const Instruction& ins)
+{
+	//Get the least significant bit of VX and store it in VF to know whether the number is even or odd
+	V[0xF] = V[ins.X] % 0x2;
+
+	//Shift VX left by 1
+	V[ins.X] = V[ins.X] << 0x1;
+
+	movePC();
+}
+
+//9xy0 - SNE Vx, Vy
+//Skip next instruction if Vx != Vy.
+void Chip8::SNE2(const Instruction& ins)
+{
+	if (V[ins.X] != V[ins.Y])
+		movePC();
+
+	movePC();
+}
+
+//Annn - LD I, addr
+//Set I = nnn.
+void Chip8::LD3(const Instruction& ins)
+{
+	// Store the trailing 12 bits in the index register
+	I = ins.NNN;
+
+	// Move the program counter by 2 bytes (short) to get the next instruction
+	movePC();
+}
+
+//Bnnn - JP V0, addr
+//Jump to location NNN + V0.
+void Chip8::JP2(const Instruction& ins)
+{
+	pc = ins.NNN;
+}
+
+//Cxnn - RND Vx, byte
+//Set Vx = random byte AND nn.
+void Chip8::RND(const Instruction& ins)
+{
+	V[ins.X] = nextRandom() & ins.NN;
+	movePC();
+}
+
+//Dxyn - DRW Vx, Vy, nibble
+//Display n-byte sprite starting at memory location I at (Vx, Vy), set VF = collision.
+void Chip8::DRW(const Instruction& ins)
+{
+	unsigned char sprite[MAX_SPRITE_HEIGHT];
+	for (int i = 0; i < ins.N; i++)
+		sprite[i] = readMemory(I + i);
+
+	unsigned int y = V[ins.Y] % SCREEN_HEIGHT;
+
+	// The start wraps around the screen, the rest of the sprite is clipped or wrapped at the edges
+	V[0xF] = drawSprite(gfx, V[ins.X], y, sprite, ins.N, screenEdge) ? 1 : 0;
+
+	// Rows a sprite byte with pixels set lands on, the same rows drawSprite draws
+	for (unsigned int i = 0; i < ins.N; i++)
+	{
+		unsigned int row = y + i;
+		if (sprite[i] == 0 || (row >= SCREEN_HEIGHT && screenEdge == EDGE_CLIP))
+			continue;
+
+		dirtyRows |= 1ULL << (row % SCREEN_HEIGHT);
+	}
+
+	movePC();
+
+	if (stopOn & STOP_ON_DRAW)
+		stopReason = RUN_DRAW;
+}
+
+//Ex9E - SKP Vx
+//Skip next instruction if key with the value of Vx is pressed.
+void Chip8::SKP(const Instruction& ins)
+{
+	if (key[V[ins.X]] != 0)
+		movePC();
+	movePC();
+}
+
+//ExA1 - SKNP Vx
+//Skip next instruction if key with the value of Vx is not pressed.
+void Chip8::SKNP(const Instruction& ins)
+{
+	if (key[V[ins.X]] == 0)
+		movePC();
+	movePC();
+}
+
+//Fx07 - LD Vx, DT
+//Set Vx = delay timer value.
+void Chip8::LD4(const Instruction& ins)
+{
+	V[ins.X] = delay_timer;
+	movePC();
+}
+
+//Fx0A - LD Vx, K
+//Wait for a key press, store the value of the key in Vx.
+void Chip8::LD5(const Instruction& ins)
+{
+	unsigned char currentKey = 0x0;
+
+	const unsigned char MAX_KEY = 0xF;
+
+	bool pressed = false;
+
+	//check if at least one key is pressed
+	for (int i = 0; i < MAX_KEY; i++)
+	{
+		if (key[i] != 0)
+		{
+			pressed = true;
+			V[ins.X] = key[i];
+		}
+	}
+
+	keyWait = !pressed;
+
+	//this will make this same opcode execute until a key is pressed
+	if (!pressed)
+	{
+		if (stopOn & STOP_ON_KEY_WAIT)
+			stopReason = RUN_KEY_WAIT;
+		else if (idleSkipping)
+			stopReason = RUN_IDLE;
+		return;
+	}
+
+	movePC();
+}
+
+//Fx15 - LD DT, Vx
+//Set delay timer = Vx.
+void Chip8::LD6(const Instruction& ins)
+{
+	delay_timer = V[ins.X];
+
+	movePC();
+}
+
+//Fx18 - LD ST, Vx
+//Set sound timer = Vx.
+void Chip8::LD7(const Instruction& ins)
+{
+	sound_timer = V[ins.X];
+
+	movePC();
+}
+
+//Fx1E - ADD I, Vx
+//Set I = I + Vx.
+void Chip8::ADD3(const Instruction& ins)
+{
+	// VF is set to 1 when range overflow (I+VX>0xFFF), and 0 when there isn't.
+	if (I + V[ins.X] > 0xFFF)
+		V[0xF] = 1;
+	else
+		V[0xF] = 0;
+
+	I += V[ins.X];
+
+	movePC();
+}
+
+//Fx29 - LD F, Vx
+//Set I = location of sprite for digit Vx. Multiply by 5 because a sprite is 5 bytes
+void Chip8::LD8(const Instruction& ins)
+{
+	I = V[ins.X] * 0x5;
+	movePC();
+}
+
+//Fx33 - LD B, Vx
+//Store BCD representation of Vx in memory locations I, I + 1, and I + 2.
+void Chip8::LD9(const Instruction& ins)
+{
+	writeMemory(I, V[ins.X] / 100);
+	writeMemory(I + 1, (V[ins.X] % 100) / 10);
+	writeMemory(I + 2, V[ins.X] % 10);
+
+	movePC();
+}
+
+
+//Fx55 - LD[I], Vx
+//Store registers V0 through Vx in memory starting at location I.
+void Chip8::LD10(const Instruction& ins)
+{
+	for (int i = 0; i < ins.X; i++)
+		writeMemory(I + i, V[i]);
+	// On the original interpreter, when the operation is done, I = I + X + 1.
+	I += ins.X + 1;
+	movePC();
+}
+
+//Fx65 - LD Vx, [I]
+//Read registers V0 through Vx from memory starting at location I.
+void Chip8::LD11(const Instruction& ins)
+{
+	for (int i = 0; i < ins.X; i++)
+		V[i] = readMemory(I + i);
+
+	// On the original interpreter, when the operation is done, I = I + X + 1.
+	I += ins.X + 1;
+	movePC();
+}
+
+//Invalid opcode
+//The program counter is not moved, same as the original interpreter.
+void Chip8::UNKNOWN(const Instruction& ins)
+{
+	printf("Unknown opcode: 0x%X\n", ins.opcode);
+}
+
+//Read the 2 byte opcode at address, wrapping around the 4k memory
+unsigned short Chip8::fetch(unsigned short address) const
+{
+	return readMemory(address) << 8 | readMemory(address + 1);
+}
+
+//Every write to memory must go through here so decoded opcodes of the address are thrown away
+void Chip8::writeMemory(unsigned short address, unsigned char value)
+{
+	address &= 0xFFF;
+	writablePage(address >> 8)[address & 0xFF] = value;
+
+	// The byte is part of the opcode starting at the address and the one before it
+	decodeCache[address].cached = false;
+	decodeCache[(address - 1) & 0xFFF].cached = false;
+
+	// Blocks decoded from the page are thrown away before the next block runs
+	dirtyPages |= codePages & (1 << (address >> 8));
+
+	// Recompiled blocks in the page are checked against memory before they run
+	writtenPages |= 1 << (address >> 8);
+}
+
+// Load fontset, the rest of memory is zeros
+// Private pages stay allocated and are copied over again on their next write
+void Chip8::clearMemory()
+{
+	memoryPages[0] = fontPage();
+	for (unsigned int i = 1; i < MEMORY_PAGES; ++i)
+		memoryPages[i] = ZERO_PAGE;
+
+	privatePageMask = 0;
+	romImage.reset();
+}
+
+void Chip8::saveState(Chip8State& state) const
+{
+	for (unsigned int page = 0; page < MEMORY_PAGES; ++page)
+		memcpy(state.memory + page * PAGE_SIZE, memoryPages[page], PAGE_SIZE);
+
+	memcpy(state.gfx, gfx, sizeof(gfx));
+	memcpy(state.stack, stack, sizeof(stack));
+	memcpy(state.V, V, sizeof(V));
+	memcpy(state.key, key, sizeof(key));
+
+	state.cycleCount = cycleCount;
+	state.idleCycles = idleCycles;
+	state.frameCycle = frameCycle;
+	state.randomState = randomState;
+	state.I = I;
+	state.pc = pc;
+	state.sp = sp;
+	state.delayTimer = delay_timer;
+	state.soundTimer = sound_timer;
+	state.keyWait = keyWait;
+}
+
+void Chip8::loadState(const Chip8State& state)
+{
+	// Snapshots taken close together differ in a few pages, the others are left shared
+	for (unsigned int page = 0; page < MEMORY_PAGES; ++page)
+	{
+		const unsigned char *saved = state.memory + page * PAGE_SIZE;
+		if (memcmp(memoryPages[page], saved, PAGE_SIZE) == 0)
+			continue;
+
+		memcpy(writablePage(page), saved, PAGE_SIZE);
+
+		// Same as writeMemory for every byte of the page
+		unsigned short start = (unsigned short)(page * PAGE_SIZE);
+		for (unsigned int i = 0; i < PAGE_SIZE; ++i)
+			decodeCache[start + i].cached = false;
+		decodeCache[(start - 1) & 0xFFF].cached = false;
+
+		dirtyPages |= codePages & (1 << page);
+		writtenPages |= 1 << page;
+	}
+
+	memcpy(gfx, state.gfx, sizeof(gfx));
+	memcpy(stack, state.stack, sizeof(stack));
+	memcpy(V, state.V, sizeof(V));
+	memcpy(key, state.key, sizeof(key));
+
+	cycleCount = state.cycleCount;
+	idleCycles = state.idleCycles;
+	frameCycle = state.frameCycle;
+	randomState = state.randomState;
+	I = state.I;
+	pc = state.pc;
+	sp = state.sp;
+	delay_timer = state.delayTimer;
+	sound_timer = state.soundTimer;
+	keyWait = state.keyWait != 0;
+
+	dirtyRows = ALL_SCREEN_ROWS;
+}
+
+unsigned char *Chip8::writablePage(unsigned int page)
+{
+	if (!(privatePageMask & (1 << page)))
+	{
+		if (!privatePages[page])
+			privatePages[page].reset(new unsigned char[PAGE_SIZE]);
+
+		memcpy(privatePages[page].get(), memoryPages[page], PAGE_SIZE);
+		memoryPages[page] = privatePages[page].get();
+		privatePageMask |= 1 << page;
+	}
+
+	return privatePages[page].get();
+}
+
+void Chip8::copyToMemory(unsigned short address, const unsigned char *bytes, size_t length)
+{
+	for (size_t i = 0; i < length; ++i)
+	{
+		unsigned short current = (address + i) & 0xFFF;
+		writablePage(current >> 8)[current & 0xFF] = bytes[i];
+	}
+}
+
+bool Chip8::memoryEquals(unsigned short address, const unsigned char *bytes, size_t length) const
+{
+	for (size_t i = 0; i < length; ++i)
+	{
+		if (readMemory((unsigned short)(address + i)) != bytes[i])
+			return false;
+	}
+
+	return true;
+}
+
+void Chip8::clearDecodeCache()
+{
+	for (int i = 0; i < 4096; ++i)
+		decodeCache[i].cached = false;
+
+	invalidateBlocks(0xFFFF);
+
+	writtenPages = 0;
+}
+
+// Run recompiled blocks until the number of cycles is executed, returns the number of cycles executed
+// Addresses without a recompiled block, computed jumps and overwritten code run in the interpreter
+unsigned long long Chip8::runStatic(unsigned long long cycles)
+{
+	unsigned long long executed = 0;
+
+	while (executed < cycles && stopReason == RUN_DONE)
+	{
+		const StaticBlock *block = staticBlocks.empty() ? NULL : staticBlocks[pc & 0xFFF];
+
+		if (block != NULL && block->address == pc && block->length <= cycles - executed &&
+			((block->pages & writtenPages) == 0 || memoryEquals(block->address, block->bytes, block->length * 2)))
+		{
+			// Only the start of recompiled blocks is traced
+			CHIP8_TRACE(trace, pc, fetch(pc), cycleCount);
+			block->code(*this);
+			executed += block->length;
+
+			// Jumps are inlined in recompiled code, JP can't see the idle loop
+			if (idleSkipping && idleLoopAt(pc))
+				stopReason = RUN_IDLE;
+		}
+		else
+		{
+			executeCycle();
+			++executed;
+		}
+	}
+
+	return executed;
+}
+
+// Run opcodes from the decode cache until the number of cycles is executed, returns the number of cycles executed
+// Built with CHIP8_THREADED_DISPATCH on GCC or Clang, every opcode jumps straight to the next opcode function
+// through a table of label addresses so each one gets its own indirect branch. Otherwise one switch dispatches them all.
+#if defined(CHIP8_THREADED_DISPATCH) && !defined(__GNUC__)
+#error CHIP8_THREADED_DISPATCH needs the labels as values extension of GCC or Clang
+#endif
+unsigned long long Chip8::runThreaded(unsigned long long cycles)
+{
+	unsigned long long executed = 0;
+	Instruction *ins = NULL;
+
+#define FETCH() \
+	if (executed == cycles || stopReason != RUN_DONE) \
+		return executed; \
+	++executed; \
+	ins = &decodeCache[pc & 0xFFF]; \
+	if (!ins->cached) \
+	{ \
+		opcode = fetch(pc); \
+		decodeInstruction(opcode, opcodeTable[opcode], *ins); \
+		ins->cached = true; \
+	}
+
+#ifdef CHIP8_THREADED_DISPATCH
+	static void *const labels[OP_COUNT] =
+	{
+		&&op_UNKNOWN,
+		&&op_CLS, &&op_RET, &&op_JP, &&op_CALL, &&op_SE, &&op_SNE, &&op_SE2, &&op_LD, &&op_ADD,
+		&&op_LD2, &&op_OR, &&op_AND, &&op_XOR, &&op_ADD2, &&op_SUB, &&op_SHR, &&op_SUBN, &&op_SHL,
+		&&op_SNE2, &&op_LD3, &&op_JP2, &&op_RND, &&op_DRW, &&op_SKP, &&op_SKNP,
+		&&op_LD4, &&op_LD5, &&op_LD6, &&op_LD7, &&op_ADD3, &&op_LD8, &&op_LD9, &&op_LD10, &&op_LD11
+	};
+
+#define DISPATCH() \
+	FETCH() \
+	goto *labels[ins->operation];
+
+#define OPERATION(name) \
+	op_##name: \
+		opcode = ins->opcode; \
+		CHIP8_TRACE(trace, pc, opcode, cycleCount); \
+		name(*ins); \
+		endCycle(); \
+		DISPATCH()
+
+	DISPATCH()
+#else
+#define OPERATION(name) \
+	case OP_##name: \
+		opcode = ins->opcode; \
+		CHIP8_TRACE(trace, pc, opcode, cycleCount); \
+		name(*ins); \
+		endCycle(); \
+		break;
+
+	for (;;)
+	{
+		FETCH()
+		switch (ins->operation)
+		{
+#endif
+
+	OPERATION(UNKNOWN)
+	OPERATION(CLS) OPERATION(RET) OPERATION(JP) OPERATION(CALL) OPERATION(SE) OPERATION(SNE) OPERATION(SE2)
+	OPERATION(LD) OPERATION(ADD) OPERATION(LD2) OPERATION(OR) OPERATION(AND) OPERATION(XOR) OPERATION(ADD2)
+	OPERATION(SUB) OPERATION(SHR) OPERATION(SUBN) OPERATION(SHL) OPERATION(SNE2) OPERATION(LD3) OPERATION(JP2)
+	OPERATION(RND) OPERATION(DRW) OPERATION(SKP) OPERATION(SKNP) OPERATION(LD4) OPERATION(LD5) OPERATION(LD6)
+	OPERATION(LD7) OPERATION(ADD3) OPERATION(LD8) OPERATION(LD9) OPERATION(LD10) OPERATION(LD11)
+
+#ifndef CHIP8_THREADED_DISPATCH
+		}
+	}
+#endif
+
+#undef OPERATION
+#undef DISPATCH
+#undef FETCH
+}
+
+// Run a single opcode at the current program counter, used by recompiled code for the opcodes it doesn't inline
+void Chip8::executeOpcode(unsigned short opcode)
+{
+	Instruction ins;
+	this->opcode = opcode;
+	decodeInstruction(opcode, opcodeTable[opcode], ins);
+	(this->*handlers[ins.operation])(ins);
+	endCycle();
+}
+
+// Count the opcode, the timers tick once per frame in tickTimers
+void Chip8::endCycle()
+{
+	++cycleCount;
+}
+
+// Update timers
+void Chip8::tickTimers()
+{
+	if (delay_timer > 0)
+		--delay_timer;
+
+	if (sound_timer > 0)
+	{
+		if (sound_timer == 1)
+			printf("BEEP!\n");
+
+		--sound_timer;
+	}
+}
+
+// Opcodes after which the program counter can't be known when decoding, that can write over decoded opcodes,
+// or that can stop run
+bool Chip8::endsBlock(unsigned char operation)
+{
+	switch (operation)
+	{
+	case OP_UNKNOWN:
+	case OP_CLS:
+	case OP_DRW:
+	case OP_RET:
+	case OP_JP:
+	case OP_CALL:
+	case OP_SE:
+	case OP_SNE:
+	case OP_SE2:
+	case OP_SNE2:
+	case OP_JP2:
+	case OP_SKP:
+	case OP_SKNP:
+	case OP_LD5:
+	case OP_LD9:
+	case OP_LD10:
+		return true;
+
+	default:
+		return false;
+	}
+}
+
+bool Chip8::knowsOpcode(unsigned short opcode)
+{
+	return decode(opcode) != OP_UNKNOWN;
+}
+
+bool Chip8::opcodeEndsBlock(unsigned short opcode)
+{
+	return endsBlock(decode(opcode));
+}
+
+// Decode the opcodes starting at address into its block
+Chip8::Block *Chip8::compileBlock(unsigned short address)
+{
+	const size_t MAX_BLOCK_LENGTH = 64;
+
+	Block& block = blocks[address];
+	block.ops.clear();
+	block.next[0] = block.next[1] = NULL;
+	block.start = address;
+	block.pages = 0;
+	block.runs = 0;
+
+	unsigned int current = address;
+	for (;;)
+	{
+		Instruction ins;
+		unsigned short opcode = fetch(current);
+		decodeInstruction(opcode, opcodeTable[opcode], ins);
+		block.ops.push_back(ins);
+
+		block.pages |= 1 << (current >> 8);
+		block.pages |= 1 << (((current + 1) & 0xFFF) >> 8);
+
+		current += 2;
+		if (endsBlock(ins.operation) || block.ops.size() == MAX_BLOCK_LENGTH || current > 0xFFF)
+			break;
+	}
+
+	block.valid = true;
+	codePages |= block.pages;
+	compiledBlocks.push_back(address);
+	return &block;
+}
+
+// Throw away every block decoded from one of the pages whose opcodes changed
+// Games often keep variables next to their code, writing them leaves the opcodes as they were
+void Chip8::invalidateBlocks(unsigned short pages)
+{
+	size_t kept = 0;
+	codePages = 0;
+
+	for (size_t i = 0; i < compiledBlocks.size(); ++i)
+	{
+		Block& block = blocks[compiledBlocks[i]];
+		if ((block.pages & pages) != 0 && !blockUnchanged(block))
+		{
+			block.valid = false;
+			if (jit)
+				jit->forget(block.start);
+		}
+		else
+		{
+			codePages |= block.pages;
+			compiledBlocks[kept++] = compiledBlocks[i];
+		}
+	}
+
+	compiledBlocks.resize(kept);
+	dirtyPages = 0;
+}
+
+// True when memory still holds the opcodes the block was decoded from
+bool Chip8::blockUnchanged(const Block& block) const
+{
+	unsigned int current = block.start;
+	for (size_t i = 0; i < block.ops.size(); ++i, current += 2)
+		if (fetch(current) != block.ops[i].opcode)
+			return false;
+
+	return true;
+}
+
+// Compile the block, starting over with an empty code buffer when it is full
+void Chip8::jitBlock(const Block& block)
+{
+	if (jit->compile(block))
+		return;
+
+	// Blocks thrown away with the buffer are compiled again once they run
+	jit->reset();
+	for (size_t i = 0; i < compiledBlocks.size(); ++i)
+		blocks[compiledBlocks[i]].runs = 0;
+
+	// A block that doesn't fit an empty buffer runs in the interpreter
+	jit->compile(block);
+}
+
+//move the progarm counter by 2 bytes
+void Chip8::movePC()
+{
+	pc += 2;
+}
+
+void Chip8::clearGFX()
+{
+	// Rows that were already blank don't change
+	for (unsigned int i = 0; i < SCREEN_HEIGHT; ++i)
+		for (unsigned int j = 0; j < SCREEN_ROW_WORDS; ++j)
+			if (gfx[i][j] != 0)
+				dirtyRows |= 1ULL << i;
+
+	memset(gfx, 0, sizeof(gfx));
+}
@@ -0,0 +1,482 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name: Chip 8 Interpreter
+//
+// Author: Jonathan Del Corpo
+// Contact: jonathan_delcorpo@hotmail.com
+//
+// License: GNU General Public License (GPL) v2 
+// ( http://www.gnu.org/licenses/old-licenses/gpl-2.0.html )
+//
+///////////////////////////////////////////////////////////////////////////////
+#define _CRT_SECURE_NO_WARNINGS
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include <fstream>
+#include <cstring>
+#include <cstddef>
+#include <iostream>
+#include <time.h>
+#include <cstdio>
+#include <cstdlib>
+#include "Trace.h"
+#include "Screen.h"
+#include "State.h"
+
+//Opcodes run by Chip8::runFrame unless setCyclesPerFrame is called, 600 per second at 60 frames per second
+const unsigned int DEFAULT_CYCLES_PER_FRAME = 10;
+
+class Chip8;
+
+template <unsigned int LANES>
+class Lockstep;
+
+struct RomImage;
+
+class Jit;
+
+//Straight line run of opcodes of a ROM recompiled to C++ by -recompile
+struct StaticBlock
+{
+	void (*code)(Chip8& chip8);
+	unsigned short address;
+	unsigned short length;			//number of opcodes
+	unsigned short pages;			//bit for every 256 byte memory page the opcodes are in
+	const unsigned char *bytes;		//opcodes the block was recompiled from
+};
+
+//Every block recompiled from one ROM
+struct StaticRom
+{
+	unsigned long long hash;		//Chip8::hashRom of the ROM
+	size_t size;
+	const StaticBlock *blocks;
+	size_t blockCount;
+};
+
+class Chip8
+{
+	//Recompiled code accesses the registers through StaticCode
+	friend struct StaticCode;
+
+	//Lockstep decodes with the same opcode table
+	template <unsigned int LANES>
+	friend class Lockstep;
+
+	//Decodes ROMs ahead of time with the opcode table
+	friend struct RomImage;
+
+	//Compiles decoded blocks, the compiled code reads and writes the registers directly
+	friend class Jit;
+
+public:
+	//Which CPU core run uses, executeCycle always runs a single opcode
+	enum Core
+	{
+		CORE_SWITCH,	//decode every opcode through the nested switch
+		CORE_TABLE,		//look the opcode up in the precomputed opcode table
+		CORE_CACHED,	//reuse the opcode decoded the last time the address was executed
+		CORE_BLOCK,		//run whole decoded blocks of opcodes
+		CORE_JIT,		//CORE_BLOCK compiled to x86-64, same as CORE_BLOCK on other hosts or with tracing
+		CORE_STATIC,	//run the recompiled blocks of the loaded ROM
+		CORE_THREADED	//every opcode function jumps straight to the next one
+	};
+
+	//Why run returned
+	enum RunResult
+	{
+		RUN_DONE,		//every cycle was executed
+		RUN_DRAW,		//the screen was drawn to or cleared (STOP_ON_DRAW)
+		RUN_KEY_WAIT,	//Fx0A is waiting for a key (STOP_ON_KEY_WAIT)
+		RUN_IDLE		//only used inside run, the program is in a loop that can be skipped
+	};
+
+	//Events that make run return before executing every cycle
+	enum RunStop
+	{
+		STOP_NONE = 0,
+		STOP_ON_DRAW = 1,
+		STOP_ON_KEY_WAIT = 2
+	};
+
+	//ROMs are loaded at ROM_START and can fill the memory up to the end
+	static const unsigned short ROM_START = 0x200;
+	static const size_t MAX_ROM_SIZE = 4096 - ROM_START;
+
+	//Memory is split in pages that are shared between instances until written to
+	static const unsigned int PAGE_SIZE = 256;
+	static const unsigned int MEMORY_PAGES = 4096 / PAGE_SIZE;
+
+	//Why loadGame failed
+	enum LoadResult
+	{
+		LOAD_OK,
+		LOAD_NOT_FOUND,		//the file can't be opened
+		LOAD_READ_ERROR,	//the file opened but couldn't be read completely
+		LOAD_TOO_BIG		//the ROM is bigger than MAX_ROM_SIZE, nothing was loaded
+	};
+
+private:
+	//Opcode with its operands extracted
+	struct Instruction
+	{
+		unsigned short opcode;
+		unsigned short NNN;		//lowest 12 bits
+		unsigned char operation;
+		unsigned char X;		//lower 4 bits of the high byte
+		unsigned char Y;		//upper 4 bits of the low byte
+		unsigned char N;		//lowest 4 bits
+		unsigned char NN;		//lowest 8 bits
+		bool cached;			//false when the decode cache entry must be decoded again
+	};
+
+	//Straight line run of opcodes, ends at an opcode that can change the program counter or write memory
+	struct Block
+	{
+		std::vector<Instruction> ops;
+		Block *next[2];			//blocks that ran after this one, checked before looking the program counter up
+		unsigned short start;
+		unsigned short pages;	//bit for every 256 byte memory page the opcodes were read from
+		bool valid;
+		unsigned int runs;		//times CORE_JIT reached the block, compiled when it gets hot
+	};
+
+	//Opcode functions indexed by the table below
+	typedef void (Chip8::*OpcodeHandler)(const Instruction& ins);
+
+	//One entry per opcode function, OP_UNKNOWN is used for invalid opcodes
+	enum Operation
+	{
+		OP_UNKNOWN,
+		OP_CLS, OP_RET, OP_JP, OP_CALL, OP_SE, OP_SNE, OP_SE2, OP_LD, OP_ADD,
+		OP_LD2, OP_OR, OP_AND, OP_XOR, OP_ADD2, OP_SUB, OP_SHR, OP_SUBN, OP_SHL,
+		OP_SNE2, OP_LD3, OP_JP2, OP_RND, OP_DRW, OP_SKP, OP_SKNP,
+		OP_LD4, OP_LD5, OP_LD6, OP_LD7, OP_ADD3, OP_LD8, OP_LD9, OP_LD10, OP_LD11,
+		OP_COUNT
+	};
+
+	//Handler for every Operation
+	static const OpcodeHandler handlers[OP_COUNT];
+
+	//Operation of every possible 16 bit opcode, built once from decode()
+	static unsigned char opcodeTable[0x10000];
+
+	static bool buildOpcodeTable();
+
+	static void loadOpcodeTable();
+
+	static unsigned char decode(unsigned short opcode);
+
+	static void decodeInstruction(unsigned short opcode, unsigned char operation, Instruction& ins);
+
+	Core core;
+
+	//Decoded opcode for every address, filled the first time the address is executed
+	Instruction decodeCache[4096];
+
+	//Block starting at every address, only allocated when CORE_BLOCK or CORE_JIT is used
+	std::vector<Block> blocks;
+
+	//Start address of every valid block
+	std::vector<unsigned short> compiledBlocks;
+
+	//Memory pages blocks were decoded from, and the ones of those written since
+	unsigned short codePages;
+	unsigned short dirtyPages;
+
+	//Only created when CORE_JIT is used
+	std::unique_ptr<Jit> jit;
+
+	//Memory pages written since the game was loaded
+	unsigned short writtenPages;
+
+	//Recompiled block starting at every address, empty when the loaded ROM wasn't recompiled
+	std::vector<const StaticBlock *> staticBlocks;
+
+	//35 opcodes, 2 bytes each
+	unsigned short opcode;
+
+	//4k memory
+	/*
+	** MEMORY MAP:
+	** 0x000 - 0x1FF - Chip 8 interpreter (contains font set in emu)
+	** 0x050 - 0x0A0 - Used for the built in 4x5 pixel font set (0-F)
+	** 0x200 - 0xFFF - Program ROM and work RAM
+	*/
+	//Split in 256 byte pages, the same pages the block cores track writes with.
+	//A page that was never written points at shared read only bytes (the font page, the zero page or a page
+	//of the loaded RomImage) and gets a private copy the first time it is written to.
+	const unsigned char *memoryPages[MEMORY_PAGES];
+
+	//Private copies, allocated on the first write to the page and kept for the next game
+	std::unique_ptr<unsigned char[]> privatePages[MEMORY_PAGES];
+
+	//Bit for every page of memoryPages pointing at its private copy
+	unsigned short privatePageMask;
+
+	//Keeps the shared pages of the loaded ROM alive
+	std::shared_ptr<const RomImage> romImage;
+
+	static const unsigned char *fontPage();
+
+	//Point every page at the font page or the zero page
+	void clearMemory();
+
+	//CPU registers, 15 8-bit general purpose registers (V0-VE)(VF carry flag)
+	unsigned char V[16];
+
+	//Index register andprogram counter (values from 0x000 to 0xFFF)
+	unsigned short I;
+	unsigned short pc;
+
+	//Timer registers 60HZ
+	unsigned char delay_timer;
+	unsigned char sound_timer;
+
+
+	//Stack used to remember the location before a jump
+	unsigned short stack[16];
+
+	//Stack pointer
+	unsigned short sp;
+
+	//Chip 8 fontset
+	static const unsigned char chip8_fontset[80];
+
+
+	//opcode funtions (35 opcodes)//
+	void SYS(const Instruction& ins);		//00E0 - SYS addr
+	void CLS(const Instruction& ins);		//00E0 - CLS
+	void RET(const Instruction& ins);		//00EE - RET
+	void JP(const Instruction& ins);		//1nnn - JP addr
+	void CALL(const Instruction& ins);	//2nnn - CALL addr
+	void SE(const Instruction& ins);		//3xkk - SE Vx, byte
+	void SNE(const Instruction& ins);		//4xkk - SNE Vx, byte
+	void SE2(const Instruction& ins);		//5xy0 - SE Vx, Vy
+	void LD(const Instruction& ins);		//6xkk - LD Vx, byte
+	void ADD(const Instruction& ins);		//7xkk - ADD Vx, byte
+	void LD2(const Instruction& ins);		//8xy0 - LD Vx, Vy
+	void OR(const Instruction& ins);		//8xy1 - OR Vx, Vy
+	void AND(const Instruction& ins);		//8xy2 - AND Vx, Vy
+	void XOR(const Instruction& ins);		//8xy3 - XOR Vx, Vy
+	void ADD2(const Instruction& ins);	//8xy4 - ADD Vx, Vy
+	void SUB(const Instruction& ins);		//8xy5 - SUB Vx, Vy
+	void SHR(const Instruction& ins);		//8xy6 - SHR Vx {, Vy}
+	void SUBN(const Instruction& ins);	//8xy7 - SUBN Vx, Vy
+	void SHL(const Instruction& ins);		//8xyE - SHL Vx {, Vy}
+	void SNE2(const Instruction& ins);	//9xy0 - SNE Vx, Vy
+	void LD3(const Instruction& ins);		//Annn - LD I, addr
+	void JP2(const Instruction& ins);		//Bnnn - JP V0, addr
+	void RND(const Instruction& ins);		//Cxkk - RND Vx, byte
+	void DRW(const Instruction& ins);		//Dxyn - DRW Vx, Vy, nibble
+	void SKP(const Instruction& ins);		//Ex9E - SKP Vx
+	void SKNP(const Instruction& ins);	//ExA1 - SKNP Vx
+	void LD4(const Instruction& ins);		//Fx07 - LD Vx, DT
+	void LD5(const Instruction& ins);		//Fx0A - LD Vx, K
+	void LD6(const Instruction& ins);		//Fx15 - LD DT, Vx
+	void LD7(const Instruction& ins);		//Fx18 - LD ST, Vx
+	void ADD3(const Instruction& ins);	//Fx1E - ADD I, Vx
+	void LD8(const Instruction& ins);		//Fx29 - LD F, Vx
+	void LD9(const Instruction& ins);		//Fx33 - LD B, Vx
+	void LD10(const Instruction& ins);	//Fx55 - LD [I], Vx
+	void LD11(const Instruction& ins);	//Fx65 - LD Vx, [I]
+	void UNKNOWN(const Instruction& ins);	//Invalid opcode
+	/////////////////////////////////////////
+
+	void movePC();
+
+	unsigned short fetch(unsigned short address) const;
+
+	unsigned char readMemory(unsigned short address) const
+	{
+		return memoryPages[(address >> 8) & 0xF][address & 0xFF];
+	}
+
+	void writeMemory(unsigned short address, unsigned char value);
+
+	//Page made private to this instance, copied from the shared page the first time
+	unsigned char *writablePage(unsigned int page);
+
+	//Copy bytes into memory at address through writablePage
+	void copyToMemory(unsigned short address, const unsigned char *bytes, size_t length);
+
+	bool memoryEquals(unsigned short address, const unsigned char *bytes, size_t length) const;
+
+	void clearDecodeCache();
+
+	void endCycle();
+
+	static bool endsBlock(unsigned char operation);
+
+	Block *compileBlock(unsigned short address);
+
+	void invalidateBlocks(unsigned short pages);
+
+	bool blockUnchanged(const Block& block) const;
+
+	void jitBlock(const Block& block);
+
+	void executeOpcode(unsigned short opcode);
+
+	void loadStaticRom(unsigned long long hash, size_t size);
+
+	//Forget everything decoded from the old ROM once a new one is in memory
+	void romLoaded(const unsigned char *rom, size_t length);
+
+	unsigned long long runCycles(unsigned long long cycles);
+
+	unsigned long long runBlocks(unsigned long long cycles);
+
+	unsigned long long runJit(unsigned long long cycles);
+
+	unsigned long long runStatic(unsigned long long cycles);
+
+	unsigned long long runThreaded(unsigned long long cycles);
+
+	//RunStop flags of the current run and the reason it stopped
+	unsigned int stopOn;
+	RunResult stopReason;
+
+	//Opcodes executed since initialize
+	unsigned long long cycleCount;
+
+	unsigned int cyclesPerFrame;
+
+	//Opcodes of the current frame already run by runFrame
+	unsigned int frameCycle;
+
+	//Idle loops are skipped unless setIdleSkipping(false) is called, idleCycles counts the opcodes skipped
+	bool idleSkipping;
+	unsigned long long idleCycles;
+
+	//Set while the opcode at the program counter is Fx0A and no key is pressed
+	bool keyWait;
+
+	bool idleLoopAt(unsigned short address) const;
+
+	void skipIdle(unsigned long long cycles);
+
+	unsigned long long runCore(unsigned long long cycles);
+
+	//xorshift state of Cxkk, every instance has its own so instances can run on different threads
+	unsigned int randomState;
+
+	unsigned char nextRandom();
+
+	//Whether DRW clips or wraps sprites at the edges of the screen
+	ScreenEdge screenEdge;
+
+	//Screen rows changed by DRW and CLS since takeDirtyRows, bit n is row n
+	unsigned long long dirtyRows;
+
+#if CHIP8_TRACE_LEVEL >= 1
+	Trace trace;
+#endif
+
+	void clearGFX();
+
+
+	
+	 
+public:
+	Chip8();
+	~Chip8();
+
+	//Graphics (64 x 32 pixels) 2048 pixels, one bit per pixel.
+	//Pixels can either be black or white (0 or 1), see Screen.h for the layout
+	unsigned long long gfx[SCREEN_HEIGHT][SCREEN_ROW_WORDS];
+
+	//Keypad state (Hex based 0x0 - 0xF) stores current state of the key
+	unsigned char key[16];
+
+	void initialize();
+
+	void executeCycle();
+
+	RunResult run(unsigned long long cycles, unsigned int stopOn = STOP_NONE);
+
+	//Run one frame of opcodes and tick the timers, a frame is 1/60 of a second
+	RunResult runFrame(unsigned int stopOn = STOP_NONE);
+
+	//Count the delay and sound timers down, runFrame calls it once per frame
+	void tickTimers();
+
+	void setCore(Core core);
+
+	void setCyclesPerFrame(unsigned int cycles);
+
+	//Sprites are clipped unless this is set to EDGE_WRAP
+	void setScreenEdge(ScreenEdge edge);
+
+	//Makes Cxkk return the same numbers on every run, initialize seeds from the time
+	void setSeed(unsigned int seed);
+
+	unsigned long long getCycleCount();
+
+	//Skip the opcodes of a program waiting for the delay timer (Fx07, 3xnn or 4xnn, 1nnn back to Fx07) or a key (Fx0A)
+	//The state and the cycle count end up the same as running them, only the trace misses them
+	void setIdleSkipping(bool enabled);
+
+	//Opcodes skipped since initialize, included in getCycleCount
+	unsigned long long getIdleCycleCount();
+
+	//True while Fx0A waits for a key and both timers are stopped
+	//Nothing changes until a key is pressed, so a frontend can sleep instead of running frames
+	bool isWaitingForKey() const;
+
+	void dumpTrace(FILE *file);
+
+	//dumpTrace for signal handlers, see Trace::writeDump
+	void writeTrace(int fd) const;
+
+	//Read the ROM into memory at ROM_START, nothing is loaded unless LOAD_OK is returned
+	LoadResult loadGame(const std::string& gamePath);
+
+	//Load a ROM already in memory
+	LoadResult loadGame(const unsigned char *rom, size_t length);
+
+	//Copy the whole machine state, fast enough to snapshot every frame for rewind or search
+	void saveState(Chip8State& state) const;
+
+	//Go back to a saved state, only the memory pages that differ are copied and have their decoded opcodes thrown away
+	//The settings and the loaded game stay, the screen is reported as changed
+	void loadState(const Chip8State& state);
+
+	//Load a ROM decoded by RomCache, the decode cache starts out filled and nothing is hashed again
+	//Memory pages are shared with the image until they are written to
+	LoadResult loadGame(const std::shared_ptr<const RomImage>& image);
+
+	//Read a ROM file into a buffer of MAX_ROM_SIZE bytes, length is set to the size of the ROM
+	static LoadResult readRom(const std::string& gamePath, unsigned char *buffer, size_t& length);
+
+	//Message for printing a LoadResult
+	static const char *describeLoadResult(LoadResult result);
+
+	unsigned char getDelayTimer();
+
+	unsigned char getPixel(unsigned int x, unsigned int y) const;
+
+	//One byte per pixel, for frontends that draw pixel by pixel
+	void expandScreen(unsigned char pixels[SCREEN_HEIGHT][SCREEN_WIDTH]) const;
+
+	//True when a pixel changed since takeDirtyRows was last called
+	bool getDrawFlag() const;
+
+	//Rows changed since the last call, bit n is row n, then starts tracking again
+	unsigned long long takeDirtyRows();
+
+	//hashRom of gfx, changes whenever a pixel does
+	unsigned long long hashScreen() const;
+
+	static unsigned long long hashRom(const unsigned char *bytes, size_t length);
+
+	static bool registerStaticRom(const StaticRom *rom);
+
+	//False for opcodes the cores run as UNKNOWN
+	static bool knowsOpcode(unsigned short opcode);
+
+	//True for opcodes decoded blocks end at, the recompiler ends its blocks at the same opcodes
+	static bool opcodeEndsBlock(unsigned short opcode);
+};
+
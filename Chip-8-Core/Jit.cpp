@@ -0,0 +1,839 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name: Chip 8 Interpreter
+//
+// Author: Jonathan Del Corpo
+// Contact: jonathan_delcorpo@hotmail.com
+//
+// License: GNU General Public License (GPL) v2 
+// ( http://www.gnu.org/licenses/old-licenses/gpl-2.0.html )
+//
+///////////////////////////////////////////////////////////////////////////////
+#include "Jit.h"
+
+#ifdef CHIP8_JIT_X64
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+#endif
+
+//Code address for every Chip8 address, in front of the code so blocks reach it relative to the instruction pointer
+const size_t JIT_TABLE_SIZE = 4096 * sizeof(unsigned char *);
+
+//Size of the code memory, reset when full
+const size_t JIT_CODE_SIZE = 1024 * 1024;
+
+//Protection is changed a page at a time
+const size_t JIT_PAGE_SIZE = 4096;
+
+//Largest number of bytes a single opcode compiles to, Fx65 loading 15 registers
+const size_t JIT_MAX_OPCODE_SIZE = 640;
+
+//x86 register numbers
+const unsigned char EAX = 0;
+const unsigned char ECX = 1;
+const unsigned char EDX = 2;
+const unsigned char EBX = 3;
+const unsigned char EBP = 5;
+const unsigned char ESI = 6;
+const unsigned char EDI = 7;
+const unsigned char R8 = 8;
+const unsigned char R9 = 9;
+const unsigned char R10 = 10;
+const unsigned char R11 = 11;
+const unsigned char R12 = 12;
+const unsigned char R13 = 13;
+const unsigned char R14 = 14;
+const unsigned char R15 = 15;
+
+//Host register holding every V register, VB-VE stay in memory
+//rax and rcx are scratch registers, rbx points at the Chip8 and the cycles left are on top of the stack
+const unsigned char IN_MEMORY = 0xFF;
+const unsigned char PINNED[16] =
+{
+	EDX, ESI, EDI, EBP, R8, R9, R10, R11, R12, R13, R14, IN_MEMORY, IN_MEMORY, IN_MEMORY, IN_MEMORY, R15
+};
+
+//Condition codes of jcc, JMP is an unconditional jmp
+const unsigned char JB = 0x2;
+const unsigned char JE = 0x4;
+const unsigned char JNE = 0x5;
+const unsigned char JA = 0x7;
+const unsigned char JMP = 0xFF;
+
+//Compiled code is entered with the Chip8 and the number of cycles it may run, and returns the cycles left
+typedef unsigned long long (*Entry)(Chip8 *chip8, unsigned long long cycles);
+
+Jit::Jit(const Chip8& chip8) : memory(NULL), table(NULL), code(NULL), size(0), used(0),
+	entryOffset(0), exitOffset(0), blocksOffset(0)
+{
+	const unsigned char *base = (const unsigned char *)&chip8;
+	vOffset = chip8.V - base;
+	iOffset = (const unsigned char *)&chip8.I - base;
+	pcOffset = (const unsigned char *)&chip8.pc - base;
+	spOffset = (const unsigned char *)&chip8.sp - base;
+	stackOffset = (const unsigned char *)chip8.stack - base;
+	delayOffset = &chip8.delay_timer - base;
+	soundOffset = &chip8.sound_timer - base;
+	keyOffset = chip8.key - base;
+	pagesOffset = (const unsigned char *)chip8.memoryPages - base;
+	idleOffset = (const unsigned char *)&chip8.idleSkipping - base;
+
+#ifdef CHIP8_JIT_X64
+	// Never writable and executable at once, code is written and then switched to read and execute by compile
+#ifdef _WIN32
+	memory = (unsigned char *)VirtualAlloc(NULL, JIT_TABLE_SIZE + JIT_CODE_SIZE, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+#else
+	void *mapped = mmap(NULL, JIT_TABLE_SIZE + JIT_CODE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	memory = mapped == MAP_FAILED ? NULL : (unsigned char *)mapped;
+#endif
+	if (memory == NULL)
+		return;
+
+	table = (unsigned char **)memory;
+	code = memory + JIT_TABLE_SIZE;
+	size = JIT_CODE_SIZE;
+
+	emitEntry();
+	emitExit();
+
+	// The entry and exit code get pages of their own that stay executable
+	blocksOffset = (used + JIT_PAGE_SIZE - 1) / JIT_PAGE_SIZE * JIT_PAGE_SIZE;
+	used = blocksOffset;
+	if (!protect(0, blocksOffset, true))
+	{
+		release();
+		return;
+	}
+
+	for (unsigned int i = 0; i < 4096; ++i)
+		table[i] = code + exitOffset;
+#endif
+}
+
+Jit::~Jit()
+{
+	release();
+}
+
+void Jit::release()
+{
+#ifdef CHIP8_JIT_X64
+	if (memory == NULL)
+		return;
+#ifdef _WIN32
+	VirtualFree(memory, 0, MEM_RELEASE);
+#else
+	munmap(memory, JIT_TABLE_SIZE + JIT_CODE_SIZE);
+#endif
+	memory = NULL;
+#endif
+}
+
+bool Jit::available() const
+{
+	return memory != NULL;
+}
+
+bool Jit::compile(const Chip8::Block& block)
+{
+	size_t count = block.ops.size();
+	if (!available() || used + 64 + 2 * count * (JIT_MAX_OPCODE_SIZE + 32) > size)
+		return false;
+
+	// The last block may share its page with this one
+	if (used % JIT_PAGE_SIZE != 0 && !protect(used - used % JIT_PAGE_SIZE, JIT_PAGE_SIZE, false))
+		return false;
+
+	size_t start = used;
+	unsigned short address = block.start;
+
+	// The whole block is counted on the way in
+	byte(0x48); byte(0x83); byte(0x2C); byte(0x24); byte((unsigned char)count);	// sub qword [rsp], count
+	size_t tooFew = branch(JB);
+
+	size_t compiled = 0;
+	for (; compiled < count; ++compiled)
+		if (!emitBlockOpcode(block, compiled))
+			break;
+
+	// Nothing to run, the interpreter keeps the whole block
+	if (compiled == 0)
+	{
+		used = start;
+	}
+	else
+	{
+		finishBlock(block, compiled, 0);
+		land(tooFew);
+		emitCounted(block, compiled);
+	}
+
+	size_t first = start - start % JIT_PAGE_SIZE;
+	size_t last = (used + JIT_PAGE_SIZE - 1) / JIT_PAGE_SIZE * JIT_PAGE_SIZE;
+	if (last > first && !protect(first, last - first, true))
+	{
+		reset();
+		return false;
+	}
+
+	if (compiled != 0)
+		table[address & 0xFFF] = code + start;
+	return true;
+}
+
+//With fewer cycles left than the block has its opcodes are compiled again, counting them one at a time
+void Jit::emitCounted(const Chip8::Block& block, size_t compiled)
+{
+	size_t count = block.ops.size();
+
+	byte(0x48); byte(0x83); byte(0x04); byte(0x24); byte((unsigned char)count);	// add qword [rsp], count
+
+	for (size_t i = 0; i < compiled; ++i)
+	{
+		byte(0x48); byte(0x83); byte(0x3C); byte(0x24); byte(0x00);	// cmp qword [rsp], 0
+		size_t left = branch(JNE);
+		returnAt(block.start + 2 * (unsigned int)i, 0);
+		land(left);
+		byte(0x48); byte(0x83); byte(0x2C); byte(0x24); byte(0x01);	// sub qword [rsp], 1
+
+		emitBlockOpcode(block, i);
+	}
+
+	finishBlock(block, compiled, 1);
+}
+
+bool Jit::emitBlockOpcode(const Chip8::Block& block, size_t i)
+{
+	const Chip8::Instruction& ins = block.ops[i];
+	unsigned short current = (unsigned short)(block.start + 2 * i);
+
+	return Chip8::endsBlock(ins.operation) ?
+		emitJump(current, ins.opcode, ins.operation) : emitOpcode(ins.opcode, ins.operation);
+}
+
+//Leave a block after its compiled opcodes, counted is 1 when each opcode was counted as it ran
+void Jit::finishBlock(const Chip8::Block& block, size_t compiled, unsigned int counted)
+{
+	size_t count = block.ops.size();
+	unsigned int next = block.start + 2 * (unsigned int)compiled;
+
+	// The interpreter runs the opcode that couldn't be compiled, the cycles counted for it and the rest are given back
+	if (compiled < count)
+		returnAt(next, counted ? 0 : (unsigned int)(count - compiled));
+
+	// Blocks cut at their maximum length or the end of memory run into the next address
+	else if (!Chip8::endsBlock(block.ops[count - 1].operation))
+		continueAt(next);
+}
+
+bool Jit::compiled(unsigned short address) const
+{
+	return available() && table[address & 0xFFF] != code + exitOffset;
+}
+
+void Jit::forget(unsigned short address)
+{
+	if (available())
+		table[address & 0xFFF] = code + exitOffset;
+}
+
+void Jit::reset()
+{
+	if (!available())
+		return;
+
+	for (unsigned int i = 0; i < 4096; ++i)
+		table[i] = code + exitOffset;
+
+	if (used != blocksOffset)
+		protect(blocksOffset, size - blocksOffset, false);
+
+	used = blocksOffset;
+}
+
+unsigned long long Jit::run(Chip8& chip8, unsigned long long cycles)
+{
+	Entry enter = (Entry)(code + entryOffset);
+	return cycles - enter(&chip8, cycles);
+}
+
+// Switch pages of the code between read and write for compiling and read and execute for running
+bool Jit::protect(size_t offset, size_t length, bool executable)
+{
+#ifdef CHIP8_JIT_X64
+#ifdef _WIN32
+	DWORD old;
+	if (!VirtualProtect(code + offset, length, executable ? PAGE_EXECUTE_READ : PAGE_READWRITE, &old))
+		return false;
+
+	if (executable)
+		FlushInstructionCache(GetCurrentProcess(), code + offset, length);
+	return true;
+#else
+	return mprotect(code + offset, length, executable ? PROT_READ | PROT_EXEC : PROT_READ | PROT_WRITE) == 0;
+#endif
+#else
+	(void)offset;
+	(void)length;
+	(void)executable;
+	return false;
+#endif
+}
+
+// Save the registers the ABI says are preserved, load the pinned V registers and jump to the block at the program counter
+void Jit::emitEntry()
+{
+	entryOffset = used;
+
+	byte(0x53); byte(0x55); byte(0x56); byte(0x57);		// push rbx, rbp, rsi, rdi
+	byte(0x41); byte(0x54); byte(0x41); byte(0x55);		// push r12, r13
+	byte(0x41); byte(0x56); byte(0x41); byte(0x57);		// push r14, r15
+
+#ifdef _WIN32
+	byte(0x48); byte(0x89); byte(0xCB);		// mov rbx, rcx
+	byte(0x52);								// push rdx
+#else
+	byte(0x48); byte(0x89); byte(0xFB);		// mov rbx, rdi
+	byte(0x56);								// push rsi
+#endif
+
+	// movzx reg, byte [rbx + V + x]
+	for (unsigned char x = 0; x < 16; ++x)
+	{
+		unsigned char reg = PINNED[x];
+		if (reg == IN_MEMORY)
+			continue;
+
+		if (reg >= R8)
+			byte(0x44);
+		byte(0x0F); byte(0xB6);
+		chip8Operand(reg, vOffset + x);
+	}
+
+	byte(0x0F); byte(0xB7);		// movzx eax, word [rbx + pc]
+	chip8Operand(EAX, pcOffset);
+
+	byte(0x48); byte(0x8D); byte(0x0D);		// lea rcx, [rip + table]
+	dword((unsigned int)((unsigned char *)table - (code + used + 4)));
+	byte(0xFF); byte(0x24); byte(0xC1);		// jmp [rcx + rax * 8]
+}
+
+// Store the program counter in eax and the pinned V registers, return the cycles left
+void Jit::emitExit()
+{
+	exitOffset = used;
+
+	byte(0x66); byte(0x89);		// mov word [rbx + pc], ax
+	chip8Operand(EAX, pcOffset);
+
+	// mov byte [rbx + V + x], reg, sil, dil and bpl need a REX prefix
+	for (unsigned char x = 0; x < 16; ++x)
+	{
+		unsigned char reg = PINNED[x];
+		if (reg == IN_MEMORY)
+			continue;
+
+		if (reg >= R8)
+			byte(0x44);
+		else if (reg >= 4)
+			byte(0x40);
+		byte(0x88);
+		chip8Operand(reg, vOffset + x);
+	}
+
+	byte(0x58);								// pop rax
+	byte(0x41); byte(0x5F); byte(0x41); byte(0x5E);		// pop r15, r14
+	byte(0x41); byte(0x5D); byte(0x41); byte(0x5C);		// pop r13, r12
+	byte(0x5F); byte(0x5E); byte(0x5D); byte(0x5B);		// pop rdi, rsi, rbp, rbx
+	byte(0xC3);								// ret
+}
+
+// Flags are computed from the registers before the opcode, and the result from the registers after VF is set,
+// so the compiled code matches the interpreter when X or Y is F
+bool Jit::emitOpcode(unsigned short opcode, unsigned char operation)
+{
+	unsigned char X = (opcode & 0x0F00) >> 8;
+	unsigned char Y = (opcode & 0x00F0) >> 4;
+	unsigned char NN = opcode & 0x00FF;
+	unsigned short NNN = opcode & 0x0FFF;
+	unsigned char reg = PINNED[X];
+
+	switch (operation)
+	{
+		//6xnn - LD Vx, byte
+	case Chip8::OP_LD:
+		if (reg != IN_MEMORY)
+		{
+			if (reg >= R8)
+				byte(0x41);
+			byte(0xB8 | (reg & 7));		// mov reg, NN
+			dword(NN);
+		}
+		else
+		{
+			byte(0xC6);					// mov byte [rbx + V + X], NN
+			chip8Operand(0, vOffset + X);
+			byte(NN);
+		}
+		break;
+
+		//7xnn - ADD Vx, byte
+		//A byte add leaves the upper bits of the pinned register zero
+	case Chip8::OP_ADD:
+		if (reg != IN_MEMORY)
+		{
+			if (reg >= R8)
+				byte(0x41);
+			else if (reg >= 4)
+				byte(0x40);
+			byte(0x80); byte(0xC0 | (reg & 7));		// add reg8, NN
+			byte(NN);
+		}
+		else
+		{
+			byte(0x80);					// add byte [rbx + V + X], NN
+			chip8Operand(0, vOffset + X);
+			byte(NN);
+		}
+		break;
+
+		//8xy0 - LD Vx, Vy
+	case Chip8::OP_LD2:
+		loadV(EAX, Y);
+		storeV(X, EAX);
+		break;
+
+		//8xy1 - OR Vx, Vy
+	case Chip8::OP_OR:
+		loadV(EAX, X);
+		loadV(ECX, Y);
+		byte(0x09); byte(0xC8);		// or eax, ecx
+		storeV(X, EAX);
+		break;
+
+		//8xy2 - AND Vx, Vy
+	case Chip8::OP_AND:
+		loadV(EAX, X);
+		loadV(ECX, Y);
+		byte(0x21); byte(0xC8);		// and eax, ecx
+		storeV(X, EAX);
+		break;
+
+		//8xy3 - XOR Vx, Vy
+	case Chip8::OP_XOR:
+		loadV(EAX, X);
+		loadV(ECX, Y);
+		byte(0x31); byte(0xC8);		// xor eax, ecx
+		storeV(X, EAX);
+		break;
+
+		//8xy4 - ADD Vx, Vy
+	case Chip8::OP_ADD2:
+		loadV(EAX, X);
+		loadV(ECX, Y);
+		byte(0x01); byte(0xC8);		// add eax, ecx
+		byte(0x3D); dword(0xF0);	// cmp eax, 0xF0
+		byte(0x0F); byte(0x97); byte(0xC0);	// seta al
+		storeV(0xF, EAX);
+		loadV(EAX, X);
+		loadV(ECX, Y);
+		byte(0x01); byte(0xC8);		// add eax, ecx
+		storeV(X, EAX);
+		break;
+
+		//8xy5 - SUB Vx, Vy
+	case Chip8::OP_SUB:
+		loadV(EAX, X);
+		loadV(ECX, Y);
+		byte(0x39); byte(0xC8);		// cmp eax, ecx
+		byte(0x0F); byte(0x97); byte(0xC0);	// seta al
+		storeV(0xF, EAX);
+		loadV(EAX, X);
+		loadV(ECX, Y);
+		byte(0x29); byte(0xC8);		// sub eax, ecx
+		storeV(X, EAX);
+		break;
+
+		//8xy6 - SHR Vx {, Vy}
+	case Chip8::OP_SHR:
+		loadV(EAX, X);
+		byte(0x83); byte(0xE0); byte(0x01);	// and eax, 1
+		storeV(0xF, EAX);
+		loadV(EAX, X);
+		byte(0xD1); byte(0xE8);		// shr eax, 1
+		storeV(X, EAX);
+		break;
+
+		//8xy7 - SUBN Vx, Vy
+	case Chip8::OP_SUBN:
+		loadV(EAX, Y);
+		loadV(ECX, X);
+		byte(0x39); byte(0xC8);		// cmp eax, ecx
+		byte(0x0F); byte(0x97); byte(0xC0);	// seta al
+		storeV(0xF, EAX);
+		loadV(EAX, Y);
+		loadV(ECX, X);
+		byte(0x29); byte(0xC8);		// sub eax, ecx
+		storeV(X, EAX);
+		break;
+
+		//8xyE - SHL Vx {, Vy}
+	case Chip8::OP_SHL:
+		loadV(EAX, X);
+		byte(0x83); byte(0xE0); byte(0x01);	// and eax, 1
+		storeV(0xF, EAX);
+		loadV(EAX, X);
+		byte(0xD1); byte(0xE0);		// shl eax, 1
+		storeV(X, EAX);
+		break;
+
+		//Annn - LD I, addr
+	case Chip8::OP_LD3:
+		byte(0x66); byte(0xC7);		// mov word [rbx + I], NNN
+		chip8Operand(0, iOffset);
+		word(NNN);
+		break;
+
+		//Fx07 - LD Vx, DT
+	case Chip8::OP_LD4:
+		byte(0x0F); byte(0xB6);		// movzx eax, byte [rbx + delay_timer]
+		chip8Operand(EAX, delayOffset);
+		storeV(X, EAX);
+		break;
+
+		//Fx15 - LD DT, Vx
+	case Chip8::OP_LD6:
+		loadV(EAX, X);
+		byte(0x88);					// mov byte [rbx + delay_timer], al
+		chip8Operand(EAX, delayOffset);
+		break;
+
+		//Fx18 - LD ST, Vx
+	case Chip8::OP_LD7:
+		loadV(EAX, X);
+		byte(0x88);					// mov byte [rbx + sound_timer], al
+		chip8Operand(EAX, soundOffset);
+		break;
+
+		//Fx1E - ADD I, Vx
+	case Chip8::OP_ADD3:
+		loadI(EAX);
+		loadV(ECX, X);
+		byte(0x01); byte(0xC8);		// add eax, ecx
+		byte(0x3D); dword(0xFFF);	// cmp eax, 0xFFF
+		byte(0x0F); byte(0x97); byte(0xC0);	// seta al
+		storeV(0xF, EAX);
+		loadI(EAX);
+		loadV(ECX, X);
+		byte(0x01); byte(0xC8);		// add eax, ecx
+		storeI(EAX);
+		break;
+
+		//Fx29 - LD F, Vx
+	case Chip8::OP_LD8:
+		loadV(EAX, X);
+		byte(0x8D); byte(0x04); byte(0x80);	// lea eax, [rax + rax * 4]
+		storeI(EAX);
+		break;
+
+		//Fx65 - LD Vx, [I]
+		//Every byte is read through the page table like Chip8::readMemory
+	case Chip8::OP_LD11:
+		for (unsigned char i = 0; i < X; ++i)
+		{
+			loadI(ECX);
+			if (i != 0)
+			{
+				byte(0x83); byte(0xC1); byte(i);	// add ecx, i
+			}
+			byte(0x89); byte(0xC8);				// mov eax, ecx
+			byte(0xC1); byte(0xE8); byte(0x08);	// shr eax, 8
+			byte(0x83); byte(0xE0); byte(0x0F);	// and eax, 0xF
+			byte(0x48); byte(0x8B); byte(0x84); byte(0xC3);	// mov rax, [rbx + rax * 8 + memoryPages]
+			dword((unsigned int)pagesOffset);
+			byte(0x0F); byte(0xB6); byte(0xC9);	// movzx ecx, cl
+			byte(0x0F); byte(0xB6); byte(0x04); byte(0x08);	// movzx eax, byte [rax + rcx]
+			storeV(i, EAX);
+		}
+		byte(0x66); byte(0x83);		// add word [rbx + I], X + 1
+		chip8Operand(0, iOffset);
+		byte(X + 1);
+		break;
+
+	default:
+		return false;
+	}
+
+	return true;
+}
+
+// Opcodes ending a block, the next block is reached through the table
+bool Jit::emitJump(unsigned short address, unsigned short opcode, unsigned char operation)
+{
+	unsigned char X = (opcode & 0x0F00) >> 8;
+	unsigned char Y = (opcode & 0x00F0) >> 4;
+	unsigned char NN = opcode & 0x00FF;
+	unsigned short NNN = opcode & 0x0FFF;
+	unsigned char condition;
+
+	switch (operation)
+	{
+		//1nnn - JP addr
+		//A jump to Fx07 may enter an idle loop, the interpreter runs those jumps so JP can skip the loop
+	case Chip8::OP_JP:
+		{
+			unsigned short next = (unsigned short)(NNN + 1);
+
+			byte(0x80);		// cmp byte [rbx + idleSkipping], 0
+			chip8Operand(7, idleOffset);
+			byte(0x00);
+			size_t notSkipping = branch(JE);
+
+			byte(0x48); byte(0x8B);		// mov rax, [rbx + memoryPages + page * 8]
+			chip8Operand(EAX, pagesOffset + ((NNN >> 8) & 0xF) * sizeof(unsigned char *));
+			byte(0x0F); byte(0xB6); byte(0x88);	// movzx ecx, byte [rax + offset]
+			dword(NNN & 0xFF);
+			byte(0x81); byte(0xE1); dword(0xF0);	// and ecx, 0xF0
+			byte(0x81); byte(0xF9); dword(0xF0);	// cmp ecx, 0xF0
+			size_t notF = branch(JNE);
+
+			byte(0x48); byte(0x8B);		// mov rax, [rbx + memoryPages + page * 8]
+			chip8Operand(EAX, pagesOffset + ((next >> 8) & 0xF) * sizeof(unsigned char *));
+			byte(0x80); byte(0xB8);		// cmp byte [rax + offset], 0x07
+			dword(next & 0xFF);
+			byte(0x07);
+			size_t notLoad = branch(JNE);
+
+			returnAt(address, 1);
+			land(notSkipping);
+			land(notF);
+			land(notLoad);
+			continueAt(NNN);
+		}
+		return true;
+
+		//Bnnn - JP V0, addr
+		//Same as Chip8::JP2, V0 isn't added
+	case Chip8::OP_JP2:
+		continueAt(NNN);
+		return true;
+
+		//2nnn - CALL addr
+		//A full stack goes back to the interpreter
+	case Chip8::OP_CALL:
+		{
+			byte(0x0F); byte(0xB7);		// movzx ecx, word [rbx + sp]
+			chip8Operand(ECX, spOffset);
+			byte(0x83); byte(0xF9); byte(0x0F);	// cmp ecx, 15
+			size_t full = branch(JA);
+
+			byte(0x66); byte(0xC7); byte(0x84); byte(0x4B);	// mov word [rbx + rcx * 2 + stack], address
+			dword((unsigned int)stackOffset);
+			word(address);
+			byte(0xFF); byte(0xC1);		// inc ecx
+			byte(0x66); byte(0x89);		// mov word [rbx + sp], cx
+			chip8Operand(ECX, spOffset);
+			continueAt(NNN);
+
+			land(full);
+			returnAt(address, 1);
+		}
+		return true;
+
+		//00EE - RET
+		//The return address is only known when it runs, an empty stack goes back to the interpreter
+	case Chip8::OP_RET:
+		{
+			byte(0x0F); byte(0xB7);		// movzx ecx, word [rbx + sp]
+			chip8Operand(ECX, spOffset);
+			byte(0x85); byte(0xC9);		// test ecx, ecx
+			size_t empty = branch(JE);
+
+			byte(0xFF); byte(0xC9);		// dec ecx
+			byte(0x66); byte(0x89);		// mov word [rbx + sp], cx
+			chip8Operand(ECX, spOffset);
+			byte(0x0F); byte(0xB7); byte(0x84); byte(0x4B);	// movzx eax, word [rbx + rcx * 2 + stack]
+			dword((unsigned int)stackOffset);
+			byte(0x83); byte(0xC0); byte(0x02);	// add eax, 2
+			byte(0x0F); byte(0xB7); byte(0xC0);	// movzx eax, ax
+			byte(0x3D); dword(0xFFF);	// cmp eax, 0xFFF
+			branchTo(JA, exitOffset);
+			byte(0x48); byte(0x8D); byte(0x0D);	// lea rcx, [rip + table]
+			dword((unsigned int)((unsigned char *)table - (code + used + 4)));
+			byte(0xFF); byte(0x24); byte(0xC1);	// jmp [rcx + rax * 8]
+
+			land(empty);
+			returnAt(address, 1);
+		}
+		return true;
+
+		//3xnn - SE Vx, byte
+	case Chip8::OP_SE:
+	case Chip8::OP_SNE:
+		loadV(EAX, X);
+		byte(0x3D); dword(NN);		// cmp eax, NN
+		condition = operation == Chip8::OP_SE ? JE : JNE;
+		break;
+
+		//5xy0 - SE Vx, Vy
+		//9xy0 - SNE Vx, Vy
+	case Chip8::OP_SE2:
+	case Chip8::OP_SNE2:
+		loadV(EAX, X);
+		loadV(ECX, Y);
+		byte(0x39); byte(0xC8);		// cmp eax, ecx
+		condition = operation == Chip8::OP_SE2 ? JE : JNE;
+		break;
+
+		//Ex9E - SKP Vx
+		//ExA1 - SKNP Vx
+		//Indexes key with Vx like the interpreter does
+	case Chip8::OP_SKP:
+	case Chip8::OP_SKNP:
+		loadV(EAX, X);
+		byte(0x80); byte(0xBC); byte(0x03);	// cmp byte [rbx + rax + key], 0
+		dword((unsigned int)keyOffset);
+		byte(0x00);
+		condition = operation == Chip8::OP_SKP ? JNE : JE;
+		break;
+
+	default:
+		return false;
+	}
+
+	// Skips
+	size_t skip = branch(condition);
+	continueAt(address + 2);
+	land(skip);
+	continueAt(address + 4);
+	return true;
+}
+
+// Jump to the block at address with eax holding the address, past the end of memory goes back to the interpreter
+void Jit::continueAt(unsigned int address)
+{
+	byte(0xB8); dword(address);		// mov eax, address
+	if (address > 0xFFF)
+	{
+		branchTo(JMP, exitOffset);
+		return;
+	}
+
+	byte(0xFF); byte(0x25);			// jmp [rip + table + address * 8]
+	dword((unsigned int)((unsigned char *)&table[address] - (code + used + 4)));
+}
+
+// Go back to the interpreter at address, giving back the cycles of the opcodes that didn't run
+void Jit::returnAt(unsigned int address, unsigned int refund)
+{
+	if (refund != 0)
+	{
+		byte(0x48); byte(0x83); byte(0x04); byte(0x24); byte((unsigned char)refund);	// add qword [rsp], refund
+	}
+	byte(0xB8); dword(address);		// mov eax, address
+	branchTo(JMP, exitOffset);
+}
+
+void Jit::byte(unsigned char b)
+{
+	code[used++] = b;
+}
+
+void Jit::word(unsigned short w)
+{
+	byte(w & 0xFF);
+	byte(w >> 8);
+}
+
+void Jit::dword(unsigned int d)
+{
+	word(d & 0xFFFF);
+	word(d >> 16);
+}
+
+// jcc or jmp with a 32 bit offset, returns where the offset is so land can point it at the code that follows
+size_t Jit::branch(unsigned char condition)
+{
+	if (condition == JMP)
+	{
+		byte(0xE9);
+	}
+	else
+	{
+		byte(0x0F); byte(0x80 | condition);
+	}
+
+	size_t at = used;
+	dword(0);
+	return at;
+}
+
+void Jit::land(size_t at)
+{
+	size_t end = used;
+	used = at;
+	dword((unsigned int)(end - (at + 4)));
+	used = end;
+}
+
+void Jit::branchTo(unsigned char condition, size_t target)
+{
+	size_t at = branch(condition);
+	size_t end = used;
+	used = at;
+	dword((unsigned int)(target - (at + 4)));
+	used = end;
+}
+
+// [rbx + offset] with reg in the reg field
+void Jit::chip8Operand(unsigned char reg, size_t offset)
+{
+	byte(0x80 | (reg & 7) << 3 | EBX);
+	dword((unsigned int)offset);
+}
+
+// reg = Vx, reg is eax or ecx
+void Jit::loadV(unsigned char reg, unsigned char x)
+{
+	unsigned char pinned = PINNED[x];
+	if (pinned == IN_MEMORY)
+	{
+		byte(0x0F); byte(0xB6);		// movzx reg, byte [rbx + V + x]
+		chip8Operand(reg, vOffset + x);
+		return;
+	}
+
+	if (pinned >= R8)
+		byte(0x41);
+	byte(0x8B); byte(0xC0 | reg << 3 | (pinned & 7));	// mov reg, pinned
+}
+
+// Vx = low byte of reg, reg is eax or ecx
+void Jit::storeV(unsigned char x, unsigned char reg)
+{
+	unsigned char pinned = PINNED[x];
+	if (pinned == IN_MEMORY)
+	{
+		byte(0x88);					// mov byte [rbx + V + x], reg8
+		chip8Operand(reg, vOffset + x);
+		return;
+	}
+
+	if (pinned >= R8)
+		byte(0x44);
+	byte(0x0F); byte(0xB6); byte(0xC0 | (pinned & 7) << 3 | reg);	// movzx pinned, reg8
+}
+
+void Jit::loadI(unsigned char reg)
+{
+	byte(0x0F); byte(0xB7);			// movzx reg, word [rbx + I]
+	chip8Operand(reg, iOffset);
+}
+
+void Jit::storeI(unsigned char reg)
+{
+	byte(0x66); byte(0x89);			// mov word [rbx + I], reg16
+	chip8Operand(reg, iOffset);
+}
@@ -0,0 +1,108 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name: Chip 8 Interpreter
+//
+// Author: Jonathan Del Corpo
+// Contact: jonathan_delcorpo@hotmail.com
+//
+// License: GNU General Public License (GPL) v2 
+// ( http://www.gnu.org/licenses/old-licenses/gpl-2.0.html )
+//
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <cstddef>
+#include "Chip8.h"
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define CHIP8_JIT_X64 1
+#endif
+
+//Compiles the decoded blocks of a Chip8 to x86-64 machine code
+//A compiled block ends by jumping to the next one through a table indexed by address, so loops run without
+//leaving the compiled code. V0-VA and VF stay in host registers from the moment run enters the compiled code
+//until it returns, VB-VE are read from the Chip8 because there are no registers left for them.
+//DRW, CLS, Fx0A, RND and the opcodes writing memory return to the interpreter.
+//Every block is compiled twice, counting its opcodes once on the way in and, when fewer cycles are left than that,
+//one at a time so the run stops after exactly the cycles asked for.
+class Jit
+{
+public:
+	//The offsets of the registers are taken from chip8, compiled code runs on any Chip8 instance
+	Jit(const Chip8& chip8);
+	~Jit();
+
+	//False when the host isn't x86-64 or executable memory can't be allocated
+	bool available() const;
+
+	//Compile the block and run it whenever its start address is reached, false when the code buffer is full
+	bool compile(const Chip8::Block& block);
+
+	//True when run has code for the address
+	bool compiled(unsigned short address) const;
+
+	//The address goes back to the interpreter until it is compiled again
+	void forget(unsigned short address);
+
+	//Throw away every compiled block
+	void reset();
+
+	//Run compiled blocks from the program counter until an opcode or address that isn't compiled is reached,
+	//or the next block is longer than the cycles left. Returns the number of opcodes executed.
+	//The program counter must be below 0x1000.
+	unsigned long long run(Chip8& chip8, unsigned long long cycles);
+
+private:
+	//Jump table followed by the code, the code pages are either writable or executable
+	unsigned char *memory;
+	unsigned char **table;
+	unsigned char *code;
+	size_t size;
+	size_t used;
+
+	//Offsets of the entry and exit code, and of the first block after them
+	size_t entryOffset;
+	size_t exitOffset;
+	size_t blocksOffset;
+
+	//Offsets from the start of the Chip8 the compiled code reads and writes
+	size_t vOffset;
+	size_t iOffset;
+	size_t pcOffset;
+	size_t spOffset;
+	size_t stackOffset;
+	size_t delayOffset;
+	size_t soundOffset;
+	size_t keyOffset;
+	size_t pagesOffset;
+	size_t idleOffset;
+
+	void release();
+
+	bool protect(size_t offset, size_t length, bool executable);
+
+	void emitEntry();
+	void emitExit();
+
+	void emitCounted(const Chip8::Block& block, size_t compiled);
+	bool emitBlockOpcode(const Chip8::Block& block, size_t i);
+	void finishBlock(const Chip8::Block& block, size_t compiled, unsigned int counted);
+
+	bool emitOpcode(unsigned short opcode, unsigned char operation);
+	bool emitJump(unsigned short address, unsigned short opcode, unsigned char operation);
+
+	void continueAt(unsigned int address);
+	void returnAt(unsigned int address, unsigned int refund);
+
+	void byte(unsigned char b);
+	void word(unsigned short w);
+	void dword(unsigned int d);
+
+	size_t branch(unsigned char condition);
+	void land(size_t at);
+	void branchTo(unsigned char condition, size_t target);
+
+	void chip8Operand(unsigned char reg, size_t offset);
+	void loadV(unsigned char reg, unsigned char x);
+	void storeV(unsigned char x, unsigned char reg);
+	void loadI(unsigned char reg);
+	void storeI(unsigned char reg);
+};
@@ -0,0 +1,580 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name: Chip 8 Interpreter
+//
+// Author: Jonathan Del Corpo
+// Contact: jonathan_delcorpo@hotmail.com
+//
+// License: GNU General Public License (GPL) v2 
+// ( http://www.gnu.org/licenses/old-licenses/gpl-2.0.html )
+//
+///////////////////////////////////////////////////////////////////////////////
+#include <cstring>
+#include "Lockstep.h"
+#ifdef CHIP8_LOCKSTEP_SSE2
+#include <emmintrin.h>
+#endif
+
+template <unsigned int LANES>
+Lockstep<LANES>::Lockstep() : cycleCount(0), groupCount(0), cyclesPerFrame(DEFAULT_CYCLES_PER_FRAME),
+	screenEdge(EDGE_CLIP)
+{
+	Chip8::loadOpcodeTable();
+}
+
+template <unsigned int LANES>
+void Lockstep<LANES>::initialize()
+{
+	memset(memory, 0, sizeof(memory));
+	memset(V, 0, sizeof(V));
+	memset(I, 0, sizeof(I));
+	memset(sp, 0, sizeof(sp));
+	memset(stack, 0, sizeof(stack));
+	memset(delayTimer, 0, sizeof(delayTimer));
+	memset(soundTimer, 0, sizeof(soundTimer));
+	memset(key, 0, sizeof(key));
+	memset(gfx, 0, sizeof(gfx));
+
+	for (unsigned int lane = 0; lane < LANES; ++lane)
+	{
+		pc[lane] = 0x200;
+		setSeed(lane, lane + 1);
+	}
+
+	for (int i = 0; i < 80; ++i)
+		memset(memory[i], Chip8::chip8_fontset[i], LANES);
+
+	cycleCount = 0;
+	groupCount = 0;
+}
+
+template <unsigned int LANES>
+Chip8::LoadResult Lockstep<LANES>::loadGame(const std::string& gamePath)
+{
+	unsigned char rom[Chip8::MAX_ROM_SIZE];
+	size_t length;
+
+	Chip8::LoadResult result = Chip8::readRom(gamePath, rom, length);
+	if (result != Chip8::LOAD_OK)
+		return result;
+
+	for (size_t i = 0; i < length; ++i)
+		memset(memory[Chip8::ROM_START + i], rom[i], LANES);
+
+	return Chip8::LOAD_OK;
+}
+
+template <unsigned int LANES>
+void Lockstep<LANES>::run(unsigned long long cycles)
+{
+	for (unsigned long long i = 0; i < cycles; ++i)
+		step();
+}
+
+template <unsigned int LANES>
+void Lockstep<LANES>::runFrame()
+{
+	run(cyclesPerFrame);
+	tickTimers();
+}
+
+template <unsigned int LANES>
+void Lockstep<LANES>::setCyclesPerFrame(unsigned int cycles)
+{
+	cyclesPerFrame = cycles;
+}
+
+template <unsigned int LANES>
+void Lockstep<LANES>::setKey(unsigned int lane, unsigned char key, unsigned char value)
+{
+	this->key[key & 0xF][lane] = value;
+}
+
+template <unsigned int LANES>
+void Lockstep<LANES>::setSeed(unsigned int lane, unsigned int seed)
+{
+	randomState[lane] = seed != 0 ? seed : 0x2545F491;
+}
+
+template <unsigned int LANES>
+void Lockstep<LANES>::setScreenEdge(ScreenEdge edge)
+{
+	screenEdge = edge;
+}
+
+template <unsigned int LANES>
+unsigned char Lockstep<LANES>::getPixel(unsigned int lane, unsigned int x, unsigned int y) const
+{
+	return getScreenPixel(gfx[lane][y % SCREEN_HEIGHT], x % SCREEN_WIDTH);
+}
+
+template <unsigned int LANES>
+unsigned long long Lockstep<LANES>::hashScreen(unsigned int lane) const
+{
+	return Chip8::hashRom((const unsigned char *)gfx[lane], sizeof(gfx[lane]));
+}
+
+template <unsigned int LANES>
+unsigned short Lockstep<LANES>::getPC(unsigned int lane) const
+{
+	return pc[lane];
+}
+
+template <unsigned int LANES>
+unsigned long long Lockstep<LANES>::getCycleCount() const
+{
+	return cycleCount;
+}
+
+template <unsigned int LANES>
+unsigned long long Lockstep<LANES>::getGroupCount() const
+{
+	return groupCount;
+}
+
+// Run one opcode on every lane, lanes at the same address with the same opcode run together
+template <unsigned int LANES>
+void Lockstep<LANES>::step()
+{
+	Mask done = {};
+
+	for (unsigned int leader = 0; leader < LANES; ++leader)
+	{
+		if (done[leader])
+			continue;
+
+		unsigned short address = pc[leader];
+		unsigned short opcode = memory[address & 0xFFF][leader] << 8 | memory[(address + 1) & 0xFFF][leader];
+
+		Mask mask;
+		matchLanes(address, opcode, done, mask);
+		execute(opcode, mask);
+		++groupCount;
+
+		for (unsigned int lane = 0; lane < LANES; ++lane)
+			done[lane] |= mask[lane];
+	}
+
+	endCycle();
+}
+
+template <unsigned int LANES>
+void Lockstep<LANES>::matchLanes(unsigned short address, unsigned short opcode, const Mask done, Mask mask) const
+{
+	// Lanes at the address can have written something else there, the opcode bytes must match too
+	const unsigned char *high = memory[address & 0xFFF];
+	const unsigned char *low = memory[(address + 1) & 0xFFF];
+
+#ifdef CHIP8_LOCKSTEP_SSE2
+	const __m128i pcs = _mm_set1_epi16((short)address);
+	const __m128i highs = _mm_set1_epi8((char)(opcode >> 8));
+	const __m128i lows = _mm_set1_epi8((char)opcode);
+
+	for (unsigned int i = 0; i < LANES; i += 8)
+	{
+		// 8 program counters compare to 8 words of 0xFFFF or 0, packed down to 8 bytes
+		__m128i lanes = _mm_cmpeq_epi16(_mm_loadu_si128((const __m128i *)(pc + i)), pcs);
+		lanes = _mm_packs_epi16(lanes, lanes);
+		lanes = _mm_and_si128(lanes, _mm_cmpeq_epi8(_mm_loadl_epi64((const __m128i *)(high + i)), highs));
+		lanes = _mm_and_si128(lanes, _mm_cmpeq_epi8(_mm_loadl_epi64((const __m128i *)(low + i)), lows));
+		lanes = _mm_andnot_si128(_mm_loadl_epi64((const __m128i *)(done + i)), lanes);
+		_mm_storel_epi64((__m128i *)(mask + i), lanes);
+	}
+#else
+	for (unsigned int lane = 0; lane < LANES; ++lane)
+	{
+		bool same = pc[lane] == address && high[lane] == (opcode >> 8) && low[lane] == (opcode & 0xFF);
+		mask[lane] = same && !done[lane] ? 0xFF : 0x00;
+	}
+#endif
+}
+
+template <unsigned int LANES>
+void Lockstep<LANES>::blend(unsigned char *dst, const unsigned char *value, const Mask mask)
+{
+#ifdef CHIP8_LOCKSTEP_SSE2
+	unsigned int i = 0;
+	for (; i + 16 <= LANES; i += 16)
+	{
+		__m128i m = _mm_loadu_si128((const __m128i *)(mask + i));
+		__m128i d = _mm_loadu_si128((const __m128i *)(dst + i));
+		__m128i v = _mm_loadu_si128((const __m128i *)(value + i));
+		_mm_storeu_si128((__m128i *)(dst + i), _mm_or_si128(_mm_and_si128(m, v), _mm_andnot_si128(m, d)));
+	}
+
+	for (; i < LANES; i += 8)
+	{
+		__m128i m = _mm_loadl_epi64((const __m128i *)(mask + i));
+		__m128i d = _mm_loadl_epi64((const __m128i *)(dst + i));
+		__m128i v = _mm_loadl_epi64((const __m128i *)(value + i));
+		_mm_storel_epi64((__m128i *)(dst + i), _mm_or_si128(_mm_and_si128(m, v), _mm_andnot_si128(m, d)));
+	}
+#else
+	for (unsigned int lane = 0; lane < LANES; ++lane)
+		dst[lane] = (dst[lane] & ~mask[lane]) | (value[lane] & mask[lane]);
+#endif
+}
+
+template <unsigned int LANES>
+void Lockstep<LANES>::movePC(const Mask mask, const Mask skip)
+{
+	for (unsigned int lane = 0; lane < LANES; ++lane)
+		pc[lane] += (mask[lane] & 2) + (mask[lane] & skip[lane] & 2);
+}
+
+template <unsigned int LANES>
+void Lockstep<LANES>::movePC(const Mask mask)
+{
+	for (unsigned int lane = 0; lane < LANES; ++lane)
+		pc[lane] += mask[lane] & 2;
+}
+
+// Same behaviour as the Chip8 opcode functions, on the lanes of the mask
+// Register opcodes are written as loops over every lane followed by a blend so the compiler can vectorize them
+template <unsigned int LANES>
+void Lockstep<LANES>::execute(unsigned short opcode, const Mask mask)
+{
+	const unsigned char X = (opcode & 0x0F00) >> 8;
+	const unsigned char Y = (opcode & 0x00F0) >> 4;
+	const unsigned char N = opcode & 0x000F;
+	const unsigned char NN = opcode & 0x00FF;
+	const unsigned short NNN = opcode & 0x0FFF;
+
+	unsigned char *Vx = V[X];
+	unsigned char *Vy = V[Y];
+	unsigned char *VF = V[0xF];
+
+	unsigned char result[LANES];
+	Mask flag;
+
+	switch (Chip8::opcodeTable[opcode])
+	{
+	case Chip8::OP_CLS:
+		for (unsigned int lane = 0; lane < LANES; ++lane)
+			if (mask[lane])
+				memset(gfx[lane], 0, sizeof(gfx[lane]));
+		movePC(mask);
+		break;
+
+	case Chip8::OP_RET:
+		for (unsigned int lane = 0; lane < LANES; ++lane)
+		{
+			if (!mask[lane])
+				continue;
+			sp[lane] = (sp[lane] - 1) & 0xF;
+			pc[lane] = stack[sp[lane]][lane] + 2;
+		}
+		break;
+
+	case Chip8::OP_JP:
+	case Chip8::OP_JP2:
+		for (unsigned int lane = 0; lane < LANES; ++lane)
+			pc[lane] = mask[lane] ? NNN : pc[lane];
+		break;
+
+	case Chip8::OP_CALL:
+		for (unsigned int lane = 0; lane < LANES; ++lane)
+		{
+			if (!mask[lane])
+				continue;
+			stack[sp[lane] & 0xF][lane] = pc[lane];
+			sp[lane] = (sp[lane] + 1) & 0xF;
+			pc[lane] = NNN;
+		}
+		break;
+
+	case Chip8::OP_SE:
+		for (unsigned int lane = 0; lane < LANES; ++lane)
+			flag[lane] = Vx[lane] == NN ? 0xFF : 0x00;
+		movePC(mask, flag);
+		break;
+
+	case Chip8::OP_SNE:
+		for (unsigned int lane = 0; lane < LANES; ++lane)
+			flag[lane] = Vx[lane] != NN ? 0xFF : 0x00;
+		movePC(mask, flag);
+		break;
+
+	case Chip8::OP_SE2:
+		for (unsigned int lane = 0; lane < LANES; ++lane)
+			flag[lane] = Vx[lane] == Vy[lane] ? 0xFF : 0x00;
+		movePC(mask, flag);
+		break;
+
+	case Chip8::OP_SNE2:
+		for (unsigned int lane = 0; lane < LANES; ++lane)
+			flag[lane] = Vx[lane] != Vy[lane] ? 0xFF : 0x00;
+		movePC(mask, flag);
+		break;
+
+	case Chip8::OP_LD:
+		memset(result, NN, LANES);
+		blend(Vx, result, mask);
+		movePC(mask);
+		break;
+
+	case Chip8::OP_ADD:
+		for (unsigned int lane = 0; lane < LANES; ++lane)
+			result[lane] = Vx[lane] + NN;
+		blend(Vx, result, mask);
+		movePC(mask);
+		break;
+
+	case Chip8::OP_LD2:
+		blend(Vx, Vy, mask);
+		movePC(mask);
+		break;
+
+	case Chip8::OP_OR:
+		for (unsigned int lane = 0; lane < LANES; ++lane)
+			result[lane] = Vx[lane] | Vy[lane];
+		blend(Vx, result, mask);
+		movePC(mask);
+		break;
+
+	case Chip8::OP_AND:
+		for (unsigned int lane = 0; lane < LANES; ++lane)
+			result[lane] = Vx[lane] & Vy[lane];
+		blend(Vx, result, mask);
+		movePC(mask);
+		break;
+
+	case Chip8::OP_XOR:
+		for (unsigned int lane = 0; lane < LANES; ++lane)
+			result[lane] = Vx[lane] ^ Vy[lane];
+		blend(Vx, result, mask);
+		movePC(mask);
+		break;
+
+	// VF is written before Vx like the Chip8 functions, that matters when x is F
+	case Chip8::OP_ADD2:
+		for (unsigned int lane = 0; lane < LANES; ++lane)
+			flag[lane] = Vx[lane] + Vy[lane] > 0xF0;
+		blend(VF, flag, mask);
+		for (unsigned int lane = 0; lane < LANES; ++lane)
+			result[lane] = Vx[lane] + Vy[lane];
+		blend(Vx, result, mask);
+		movePC(mask);
+		break;
+
+	case Chip8::OP_SUB:
+		for (unsigned int lane = 0; lane < LANES; ++lane)
+			flag[lane] = Vx[lane] > Vy[lane];
+		blend(VF, flag, mask);
+		for (unsigned int lane = 0; lane < LANES; ++lane)
+			result[lane] = Vx[lane] - Vy[lane];
+		blend(Vx, result, mask);
+		movePC(mask);
+		break;
+
+	case Chip8::OP_SHR:
+		for (unsigned int lane = 0; lane < LANES; ++lane)
+			flag[lane] = Vx[lane] & 0x1;
+		blend(VF, flag, mask);
+		for (unsigned int lane = 0; lane < LANES; ++lane)
+			result[lane] = Vx[lane] >> 1;
+		blend(Vx, result, mask);
+		movePC(mask);
+		break;
+
+	case Chip8::OP_SUBN:
+		for (unsigned int lane = 0; lane < LANES; ++lane)
+			flag[lane] = Vy[lane] > Vx[lane];
+		blend(VF, flag, mask);
+		for (unsigned int lane = 0; lane < LANES; ++lane)
+			result[lane] = Vy[lane] - Vx[lane];
+		blend(Vx, result, mask);
+		movePC(mask);
+		break;
+
+	case Chip8::OP_SHL:
+		for (unsigned int lane = 0; lane < LANES; ++lane)
+			flag[lane] = Vx[lane] & 0x1;
+		blend(VF, flag, mask);
+		for (unsigned int lane = 0; lane < LANES; ++lane)
+			result[lane] = Vx[lane] << 1;
+		blend(Vx, result, mask);
+		movePC(mask);
+		break;
+
+	case Chip8::OP_LD3:
+		for (unsigned int lane = 0; lane < LANES; ++lane)
+			I[lane] = mask[lane] ? NNN : I[lane];
+		movePC(mask);
+		break;
+
+	case Chip8::OP_RND:
+		for (unsigned int lane = 0; lane < LANES; ++lane)
+			if (mask[lane])
+				Vx[lane] = nextRandom(lane) & NN;
+		movePC(mask);
+		break;
+
+	case Chip8::OP_DRW:
+		for (unsigned int lane = 0; lane < LANES; ++lane)
+			if (mask[lane])
+				drawSprite(lane, Vx[lane], Vy[lane], N);
+		movePC(mask);
+		break;
+
+	case Chip8::OP_SKP:
+		for (unsigned int lane = 0; lane < LANES; ++lane)
+			flag[lane] = key[Vx[lane] & 0xF][lane] != 0 ? 0xFF : 0x00;
+		movePC(mask, flag);
+		break;
+
+	case Chip8::OP_SKNP:
+		for (unsigned int lane = 0; lane < LANES; ++lane)
+			flag[lane] = key[Vx[lane] & 0xF][lane] == 0 ? 0xFF : 0x00;
+		movePC(mask, flag);
+		break;
+
+	case Chip8::OP_LD4:
+		blend(Vx, delayTimer, mask);
+		movePC(mask);
+		break;
+
+	case Chip8::OP_LD5:
+		// Lanes without a key pressed stay on the opcode
+		for (unsigned int lane = 0; lane < LANES; ++lane)
+		{
+			flag[lane] = 0x00;
+			for (int i = 0; i < 0xF; ++i)
+			{
+				if (key[i][lane] != 0)
+				{
+					flag[lane] = 0xFF;
+					result[lane] = key[i][lane];
+				}
+			}
+			flag[lane] &= mask[lane];
+		}
+		blend(Vx, result, flag);
+		movePC(flag);
+		break;
+
+	case Chip8::OP_LD6:
+		blend(delayTimer, Vx, mask);
+		movePC(mask);
+		break;
+
+	case Chip8::OP_LD7:
+		blend(soundTimer, Vx, mask);
+		movePC(mask);
+		break;
+
+	case Chip8::OP_ADD3:
+		for (unsigned int lane = 0; lane < LANES; ++lane)
+			flag[lane] = I[lane] + Vx[lane] > 0xFFF;
+		blend(VF, flag, mask);
+		for (unsigned int lane = 0; lane < LANES; ++lane)
+			I[lane] += mask[lane] ? Vx[lane] : 0;
+		movePC(mask);
+		break;
+
+	case Chip8::OP_LD8:
+		for (unsigned int lane = 0; lane < LANES; ++lane)
+			I[lane] = mask[lane] ? Vx[lane] * 0x5 : I[lane];
+		movePC(mask);
+		break;
+
+	case Chip8::OP_LD9:
+		for (unsigned int lane = 0; lane < LANES; ++lane)
+		{
+			if (!mask[lane])
+				continue;
+			memory[I[lane] & 0xFFF][lane] = Vx[lane] / 100;
+			memory[(I[lane] + 1) & 0xFFF][lane] = (Vx[lane] % 100) / 10;
+			memory[(I[lane] + 2) & 0xFFF][lane] = Vx[lane] % 10;
+		}
+		movePC(mask);
+		break;
+
+	case Chip8::OP_LD10:
+		for (unsigned int lane = 0; lane < LANES; ++lane)
+		{
+			if (!mask[lane])
+				continue;
+			for (int i = 0; i < X; ++i)
+				memory[(I[lane] + i) & 0xFFF][lane] = V[i][lane];
+			I[lane] += X + 1;
+		}
+		movePC(mask);
+		break;
+
+	case Chip8::OP_LD11:
+		for (unsigned int lane = 0; lane < LANES; ++lane)
+		{
+			if (!mask[lane])
+				continue;
+			for (int i = 0; i < X; ++i)
+				V[i][lane] = memory[(I[lane] + i) & 0xFFF][lane];
+			I[lane] += X + 1;
+		}
+		movePC(mask);
+		break;
+
+	default:
+		printf("Unknown opcode: 0x%X\n", opcode);
+		break;
+	}
+}
+
+// Same as Chip8::DRW
+template <unsigned int LANES>
+void Lockstep<LANES>::drawSprite(unsigned int lane, unsigned int x, unsigned int y, unsigned char height)
+{
+	unsigned char sprite[MAX_SPRITE_HEIGHT];
+	for (unsigned int i = 0; i < height; ++i)
+		sprite[i] = memory[(I[lane] + i) & 0xFFF][lane];
+
+	V[0xF][lane] = ::drawSprite(gfx[lane], x, y, sprite, height, screenEdge) ? 1 : 0;
+}
+
+// Same sequence as Chip8::nextRandom for the same seed
+template <unsigned int LANES>
+unsigned char Lockstep<LANES>::nextRandom(unsigned int lane)
+{
+	unsigned int state = randomState[lane];
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	randomState[lane] = state;
+	return state % 0xFF;
+}
+
+template <unsigned int LANES>
+void Lockstep<LANES>::endCycle()
+{
+	++cycleCount;
+}
+
+template <unsigned int LANES>
+void Lockstep<LANES>::tickTimers()
+{
+#ifdef CHIP8_LOCKSTEP_SSE2
+	// Saturating subtract stops the timers at 0
+	const __m128i one = _mm_set1_epi8(1);
+	unsigned int i = 0;
+	for (; i + 16 <= LANES; i += 16)
+	{
+		_mm_storeu_si128((__m128i *)(delayTimer + i), _mm_subs_epu8(_mm_loadu_si128((const __m128i *)(delayTimer + i)), one));
+		_mm_storeu_si128((__m128i *)(soundTimer + i), _mm_subs_epu8(_mm_loadu_si128((const __m128i *)(soundTimer + i)), one));
+	}
+
+	for (; i < LANES; i += 8)
+	{
+		_mm_storel_epi64((__m128i *)(delayTimer + i), _mm_subs_epu8(_mm_loadl_epi64((const __m128i *)(delayTimer + i)), one));
+		_mm_storel_epi64((__m128i *)(soundTimer + i), _mm_subs_epu8(_mm_loadl_epi64((const __m128i *)(soundTimer + i)), one));
+	}
+#else
+	for (unsigned int lane = 0; lane < LANES; ++lane)
+	{
+		delayTimer[lane] -= delayTimer[lane] != 0;
+		soundTimer[lane] -= soundTimer[lane] != 0;
+	}
+#endif
+}
+
+template class Lockstep<8>;
+template class Lockstep<16>;
+template class Lockstep<32>;
@@ -0,0 +1,112 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name: Chip 8 Interpreter
+//
+// Author: Jonathan Del Corpo
+// Contact: jonathan_delcorpo@hotmail.com
+//
+// License: GNU General Public License (GPL) v2 
+// ( http://www.gnu.org/licenses/old-licenses/gpl-2.0.html )
+//
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <string>
+#include "Chip8.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CHIP8_LOCKSTEP_SSE2 1
+#endif
+
+//Runs LANES copies of one ROM side by side, one opcode of every copy per step
+//Every register is stored as an array with one entry per lane so an opcode runs on all the lanes
+//that are at the same address at once. Lanes that took a different branch are run as separate groups
+//with a mask of the lanes in the group, and join up again when they reach the same address.
+//Built for 8, 16 and 32 lanes. Too big for the stack, allocate it with new.
+template <unsigned int LANES>
+class Lockstep
+{
+public:
+	Lockstep();
+
+	//Reset every lane, the seed of lane n is n + 1
+	void initialize();
+
+	//Load the same ROM into every lane, see Chip8::loadGame
+	Chip8::LoadResult loadGame(const std::string& gamePath);
+
+	//Run the number of opcodes on every lane
+	void run(unsigned long long cycles);
+
+	//Run one frame of opcodes and tick the timers like Chip8::runFrame
+	void runFrame();
+
+	void tickTimers();
+
+	void setCyclesPerFrame(unsigned int cycles);
+
+	//Inputs are what makes the lanes different
+	void setKey(unsigned int lane, unsigned char key, unsigned char value);
+
+	void setSeed(unsigned int lane, unsigned int seed);
+
+	void setScreenEdge(ScreenEdge edge);
+
+	unsigned char getPixel(unsigned int lane, unsigned int x, unsigned int y) const;
+
+	//Chip8::hashScreen of the lane
+	unsigned long long hashScreen(unsigned int lane) const;
+
+	unsigned short getPC(unsigned int lane) const;
+
+	unsigned long long getCycleCount() const;
+
+	//Groups of lanes executed since initialize, getCycleCount() when the lanes never split up
+	unsigned long long getGroupCount() const;
+
+private:
+	static_assert(LANES == 8 || LANES == 16 || LANES == 32, "Lockstep is built for 8, 16 or 32 lanes");
+
+	//0xFF for the lanes the current opcode runs on, 0x00 for the others
+	typedef unsigned char Mask[LANES];
+
+	//memory[address][lane], lanes at the same address read the opcode bytes from one row
+	unsigned char memory[4096][LANES];
+
+	unsigned char V[16][LANES];
+	unsigned short I[LANES];
+	unsigned short pc[LANES];
+	unsigned short sp[LANES];
+	unsigned short stack[16][LANES];
+	unsigned char delayTimer[LANES];
+	unsigned char soundTimer[LANES];
+	unsigned char key[16][LANES];
+	unsigned int randomState[LANES];
+
+	//Screen of every lane, in the bit per pixel layout of Chip8::gfx
+	unsigned long long gfx[LANES][SCREEN_HEIGHT][SCREEN_ROW_WORDS];
+
+	unsigned long long cycleCount;
+	unsigned long long groupCount;
+	unsigned int cyclesPerFrame;
+	ScreenEdge screenEdge;
+
+	void step();
+
+	void execute(unsigned short opcode, const Mask mask);
+
+	//Lanes that are at the address and read the opcode from it
+	void matchLanes(unsigned short address, unsigned short opcode, const Mask done, Mask mask) const;
+
+	//dst = value in the lanes of the mask
+	static void blend(unsigned char *dst, const unsigned char *value, const Mask mask);
+
+	//Move the program counter of the lanes of the mask, by 4 bytes where skip is set
+	void movePC(const Mask mask, const Mask skip);
+
+	void movePC(const Mask mask);
+
+	void drawSprite(unsigned int lane, unsigned int x, unsigned int y, unsigned char height);
+
+	unsigned char nextRandom(unsigned int lane);
+
+	void endCycle();
+};
@@ -0,0 +1,118 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name: Chip 8 Interpreter
+//
+// Author: Jonathan Del Corpo
+// Contact: jonathan_delcorpo@hotmail.com
+//
+// License: GNU General Public License (GPL) v2 
+// ( http://www.gnu.org/licenses/old-licenses/gpl-2.0.html )
+//
+///////////////////////////////////////////////////////////////////////////////
+#include <algorithm>
+#include "RomCache.h"
+
+std::shared_ptr<const RomImage> RomImage::build(const unsigned char *rom, size_t length)
+{
+	Chip8::loadOpcodeTable();
+
+	std::shared_ptr<RomImage> image(new RomImage);
+	image->hash = Chip8::hashRom(rom, length);
+	image->bytes.assign(rom, rom + length);
+
+	image->pages.assign((length + Chip8::PAGE_SIZE - 1) / Chip8::PAGE_SIZE * Chip8::PAGE_SIZE, 0);
+	std::copy(rom, rom + length, image->pages.begin());
+
+	if (length > 1)
+	{
+		image->decoded.resize(length - 1);
+		for (size_t i = 0; i + 1 < length; ++i)
+		{
+			unsigned short opcode = rom[i] << 8 | rom[i + 1];
+			Chip8::decodeInstruction(opcode, Chip8::opcodeTable[opcode], image->decoded[i]);
+			image->decoded[i].cached = true;
+		}
+	}
+
+	return image;
+}
+
+Chip8::LoadResult RomCache::get(const std::string& gamePath, std::shared_ptr<const RomImage>& image)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		PathMap::iterator found = paths.find(gamePath);
+		if (found != paths.end())
+		{
+			image = found->second;
+			return Chip8::LOAD_OK;
+		}
+	}
+
+	unsigned char rom[Chip8::MAX_ROM_SIZE];
+	size_t length;
+
+	Chip8::LoadResult result = Chip8::readRom(gamePath, rom, length);
+	if (result != Chip8::LOAD_OK)
+		return result;
+
+	image = get(rom, length);
+
+	std::lock_guard<std::mutex> lock(mutex);
+	paths[gamePath] = image;
+	return Chip8::LOAD_OK;
+}
+
+std::shared_ptr<const RomImage> RomCache::get(const unsigned char *rom, size_t length)
+{
+	unsigned long long hash = Chip8::hashRom(rom, length);
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		std::shared_ptr<const RomImage> found = find(hash, rom, length);
+		if (found)
+			return found;
+	}
+
+	// Decoded without the lock, when another thread caches the same ROM meanwhile add keeps the first image
+	std::shared_ptr<const RomImage> built = RomImage::build(rom, length);
+
+	std::lock_guard<std::mutex> lock(mutex);
+	return add(built);
+}
+
+std::shared_ptr<const RomImage> RomCache::find(unsigned long long hash, const unsigned char *rom, size_t length)
+{
+	std::pair<ImageMap::iterator, ImageMap::iterator> range = images.equal_range(hash);
+	for (ImageMap::iterator i = range.first; i != range.second; ++i)
+	{
+		const std::vector<unsigned char>& bytes = i->second->bytes;
+		if (bytes.size() == length && std::equal(bytes.begin(), bytes.end(), rom))
+			return i->second;
+	}
+
+	return std::shared_ptr<const RomImage>();
+}
+
+std::shared_ptr<const RomImage> RomCache::add(const std::shared_ptr<const RomImage>& image)
+{
+	const std::vector<unsigned char>& bytes = image->bytes;
+	std::shared_ptr<const RomImage> found = find(image->hash, bytes.empty() ? NULL : &bytes[0], bytes.size());
+	if (found)
+		return found;
+
+	images.insert(std::make_pair(image->hash, image));
+	return image;
+}
+
+size_t RomCache::size()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return images.size();
+}
+
+void RomCache::clear()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	images.clear();
+	paths.clear();
+}
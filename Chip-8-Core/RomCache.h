@@ -0,0 +1,69 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name: Chip 8 Interpreter
+//
+// Author: Jonathan Del Corpo
+// Contact: jonathan_delcorpo@hotmail.com
+//
+// License: GNU General Public License (GPL) v2 
+// ( http://www.gnu.org/licenses/old-licenses/gpl-2.0.html )
+//
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include "Chip8.h"
+
+//ROM read and decoded once, shared read only by every Chip8 that loads it
+struct RomImage
+{
+	unsigned long long hash;	//Chip8::hashRom of bytes
+	std::vector<unsigned char> bytes;
+
+	//bytes padded with zeros to whole memory pages, mapped into the memory of every Chip8 running the ROM
+	std::vector<unsigned char> pages;
+
+	//Decoded opcode at every address of the ROM, entry i is the opcode at Chip8::ROM_START + i
+	//The last byte has no entry, the opcode starting there runs into the memory after the ROM
+	std::vector<Chip8::Instruction> decoded;
+
+	//Hash and decode a copy of the ROM, the ROM must fit in Chip8::MAX_ROM_SIZE
+	static std::shared_ptr<const RomImage> build(const unsigned char *rom, size_t length);
+};
+
+//Images of every ROM loaded through it, keyed by their contents
+//A ROM is read and decoded the first time it is asked for, after that every caller shares the same image.
+//Different paths with the same contents share one image too. Safe to use from several threads at once.
+class RomCache
+{
+public:
+	//Image of the ROM file, read from disk only the first time the path is asked for
+	Chip8::LoadResult get(const std::string& gamePath, std::shared_ptr<const RomImage>& image);
+
+	//Image of the ROM in memory, decoded only if no ROM with the same contents is cached
+	std::shared_ptr<const RomImage> get(const unsigned char *rom, size_t length);
+
+	//Number of different ROMs cached
+	size_t size();
+
+	void clear();
+
+private:
+	typedef std::unordered_multimap<unsigned long long, std::shared_ptr<const RomImage>> ImageMap;
+	typedef std::unordered_map<std::string, std::shared_ptr<const RomImage>> PathMap;
+
+	std::mutex mutex;
+
+	//Images by Chip8::hashRom, ROMs with the same hash are told apart by their bytes
+	ImageMap images;
+
+	PathMap paths;
+
+	//Cached image of the ROM, NULL when there is none, called with the mutex held
+	std::shared_ptr<const RomImage> find(unsigned long long hash, const unsigned char *rom, size_t length);
+
+	//Cached image with the same contents, or the image itself once added, called with the mutex held
+	std::shared_ptr<const RomImage> add(const std::shared_ptr<const RomImage>& image);
+};
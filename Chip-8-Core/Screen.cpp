@@ -0,0 +1,104 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name: Chip 8 Interpreter
+//
+// Author: Jonathan Del Corpo
+// Contact: jonathan_delcorpo@hotmail.com
+//
+// License: GNU General Public License (GPL) v2 
+// ( http://www.gnu.org/licenses/old-licenses/gpl-2.0.html )
+//
+///////////////////////////////////////////////////////////////////////////////
+#include "Screen.h"
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CHIP8_SCREEN_SSE2 1
+#endif
+
+// XOR the bits into count consecutive single word rows, returns true when any bit was already on
+static bool xorRows(unsigned long long *rows, const unsigned long long *bits, unsigned int count)
+{
+	unsigned int i = 0;
+	bool collision = false;
+
+#if defined(__AVX2__)
+	__m256i hits = _mm256_setzero_si256();
+	for (; i + 4 <= count; i += 4)
+	{
+		__m256i screen = _mm256_loadu_si256((const __m256i *)(rows + i));
+		__m256i sprite = _mm256_loadu_si256((const __m256i *)(bits + i));
+		hits = _mm256_or_si256(hits, _mm256_and_si256(screen, sprite));
+		_mm256_storeu_si256((__m256i *)(rows + i), _mm256_xor_si256(screen, sprite));
+	}
+	collision = !_mm256_testz_si256(hits, hits);
+#elif defined(CHIP8_SCREEN_SSE2)
+	__m128i hits = _mm_setzero_si128();
+	for (; i + 2 <= count; i += 2)
+	{
+		__m128i screen = _mm_loadu_si128((const __m128i *)(rows + i));
+		__m128i sprite = _mm_loadu_si128((const __m128i *)(bits + i));
+		hits = _mm_or_si128(hits, _mm_and_si128(screen, sprite));
+		_mm_storeu_si128((__m128i *)(rows + i), _mm_xor_si128(screen, sprite));
+	}
+	collision = _mm_movemask_epi8(_mm_cmpeq_epi8(hits, _mm_setzero_si128())) != 0xFFFF;
+#endif
+
+	for (; i < count; ++i)
+	{
+		collision |= (rows[i] & bits[i]) != 0;
+		rows[i] ^= bits[i];
+	}
+
+	return collision;
+}
+
+bool drawSprite(unsigned long long screen[SCREEN_HEIGHT][SCREEN_ROW_WORDS], unsigned int x, unsigned int y,
+	const unsigned char *sprite, unsigned int height, ScreenEdge edge)
+{
+	x %= SCREEN_WIDTH;
+	y %= SCREEN_HEIGHT;
+
+	if (height > MAX_SPRITE_HEIGHT)
+		height = MAX_SPRITE_HEIGHT;
+
+	unsigned int rows = height;
+	if (edge == EDGE_CLIP && y + rows > SCREEN_HEIGHT)
+		rows = SCREEN_HEIGHT - y;
+
+	bool collision = false;
+
+	if (SCREEN_ROW_WORDS == 1)
+	{
+		// Every sprite row shifted into place first, then all the rows are drawn at once
+		unsigned long long bits[MAX_SPRITE_HEIGHT];
+		for (unsigned int i = 0; i < rows; ++i)
+		{
+			unsigned long long row = (unsigned long long)sprite[i] << 56;
+			bits[i] = row >> x;
+
+			// Pixels shifted out on the right come back in on the left
+			if (edge == EDGE_WRAP && x != 0)
+				bits[i] |= row << (64 - x);
+		}
+
+		// Rows past the bottom edge continue from the top row
+		unsigned int first = rows < SCREEN_HEIGHT - y ? rows : SCREEN_HEIGHT - y;
+		collision |= xorRows(&screen[y][0], bits, first);
+		collision |= xorRows(&screen[0][0], bits + first, rows - first);
+	}
+	else
+	{
+		for (unsigned int i = 0; i < rows; ++i)
+		{
+			unsigned long long *row = screen[(y + i) % SCREEN_HEIGHT];
+			collision |= drawSpriteRow(row, x, sprite[i]);
+
+			// The pixels past the right edge start again at x = 0
+			if (edge == EDGE_WRAP && x + 8 > SCREEN_WIDTH)
+				collision |= drawSpriteRow(row, 0, (unsigned char)(sprite[i] << (SCREEN_WIDTH - x)));
+		}
+	}
+
+	return collision;
+}
@@ -0,0 +1,67 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name: Chip 8 Interpreter
+//
+// Author: Jonathan Del Corpo
+// Contact: jonathan_delcorpo@hotmail.com
+//
+// License: GNU General Public License (GPL) v2 
+// ( http://www.gnu.org/licenses/old-licenses/gpl-2.0.html )
+//
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+//Display size in pixels
+const unsigned int SCREEN_WIDTH = 64;
+const unsigned int SCREEN_HEIGHT = 32;
+
+//The display is stored one bit per pixel, every row is SCREEN_ROW_WORDS 64 bit words
+//Bit 63 of the first word is the leftmost pixel. A 128x64 hi-res screen is 2 words per row.
+const unsigned int SCREEN_ROW_WORDS = SCREEN_WIDTH / 64;
+
+//Bit n is row n in the dirty row masks
+const unsigned long long ALL_SCREEN_ROWS = ~0ULL >> (64 - SCREEN_HEIGHT);
+
+//Tallest sprite DRW can draw
+const unsigned int MAX_SPRITE_HEIGHT = 16;
+
+//What happens to the part of a sprite past the right or bottom edge, the start is always wrapped
+enum ScreenEdge
+{
+	EDGE_CLIP,	//not drawn
+	EDGE_WRAP	//drawn from the opposite edge
+};
+
+//XOR an 8 pixel sprite row into a screen row starting at x, pixels past the right edge are clipped
+//Returns true when a pixel that was on is turned off
+inline bool drawSpriteRow(unsigned long long *row, unsigned int x, unsigned char sprite)
+{
+	unsigned int word = x / 64;
+	unsigned int offset = x % 64;
+
+	unsigned long long bits = offset <= 56 ?
+		(unsigned long long)sprite << (56 - offset) :
+		(unsigned long long)sprite >> (offset - 56);
+
+	bool collision = (row[word] & bits) != 0;
+	row[word] ^= bits;
+
+	// The end of the sprite goes into the next word of a wider screen
+	if (offset > 56 && word + 1 < SCREEN_ROW_WORDS)
+	{
+		unsigned long long spill = (unsigned long long)sprite << (120 - offset);
+		collision |= (row[word + 1] & spill) != 0;
+		row[word + 1] ^= spill;
+	}
+
+	return collision;
+}
+
+inline unsigned char getScreenPixel(const unsigned long long *row, unsigned int x)
+{
+	return (row[x / 64] >> (63 - x % 64)) & 1;
+}
+
+//XOR a sprite of 8 pixel rows into the screen at x, y and return true when a pixel that was on is turned off
+//Rows of a 64 pixel screen are drawn several at a time with SSE2 or AVX2
+bool drawSprite(unsigned long long screen[SCREEN_HEIGHT][SCREEN_ROW_WORDS], unsigned int x, unsigned int y,
+	const unsigned char *sprite, unsigned int height, ScreenEdge edge);
@@ -0,0 +1,150 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name: Chip 8 Interpreter
+//
+// Author: Jonathan Del Corpo
+// Contact: jonathan_delcorpo@hotmail.com
+//
+// License: GNU General Public License (GPL) v2 
+// ( http://www.gnu.org/licenses/old-licenses/gpl-2.0.html )
+//
+///////////////////////////////////////////////////////////////////////////////
+#include <cstring>
+#include "State.h"
+
+// Blob layout, every value little endian:
+// "C8ST", version (2), screen width (2), screen height (2), memory (4096), gfx (8 per word),
+// cycleCount (8), idleCycles (8), frameCycle (4), randomState (4), stack (16 x 2), I (2), pc (2), sp (2),
+// V (16), key (16), delay timer (1), sound timer (1), key wait (1)
+static const unsigned char STATE_MAGIC[4] = { 'C', '8', 'S', 'T' };
+
+static void putBytes(std::vector<unsigned char>& blob, const unsigned char *bytes, size_t length)
+{
+	blob.insert(blob.end(), bytes, bytes + length);
+}
+
+static void putValue(std::vector<unsigned char>& blob, unsigned long long value, unsigned int size)
+{
+	for (unsigned int i = 0; i < size; ++i)
+		blob.push_back((unsigned char)(value >> (i * 8)));
+}
+
+// Reads the blob front to back, every read fails once the end is passed
+class StateReader
+{
+public:
+	StateReader(const unsigned char *blob, size_t length) : blob(blob), length(length), position(0) {}
+
+	bool getBytes(unsigned char *bytes, size_t size)
+	{
+		if (length - position < size)
+			return false;
+
+		memcpy(bytes, blob + position, size);
+		position += size;
+		return true;
+	}
+
+	bool getValue(unsigned long long& value, unsigned int size)
+	{
+		if (length - position < size)
+			return false;
+
+		value = 0;
+		for (unsigned int i = 0; i < size; ++i)
+			value |= (unsigned long long)blob[position + i] << (i * 8);
+		position += size;
+		return true;
+	}
+
+	template <typename T>
+	bool get(T& value)
+	{
+		unsigned long long read;
+		if (!getValue(read, sizeof(T)))
+			return false;
+
+		value = (T)read;
+		return true;
+	}
+
+	bool atEnd() const
+	{
+		return position == length;
+	}
+
+private:
+	const unsigned char *blob;
+	size_t length;
+	size_t position;
+};
+
+void serializeState(const Chip8State& state, std::vector<unsigned char>& blob)
+{
+	putBytes(blob, STATE_MAGIC, sizeof(STATE_MAGIC));
+	putValue(blob, STATE_VERSION, 2);
+	putValue(blob, SCREEN_WIDTH, 2);
+	putValue(blob, SCREEN_HEIGHT, 2);
+
+	putBytes(blob, state.memory, sizeof(state.memory));
+
+	for (unsigned int y = 0; y < SCREEN_HEIGHT; ++y)
+		for (unsigned int word = 0; word < SCREEN_ROW_WORDS; ++word)
+			putValue(blob, state.gfx[y][word], 8);
+
+	putValue(blob, state.cycleCount, 8);
+	putValue(blob, state.idleCycles, 8);
+	putValue(blob, state.frameCycle, 4);
+	putValue(blob, state.randomState, 4);
+
+	for (int i = 0; i < 16; ++i)
+		putValue(blob, state.stack[i], 2);
+
+	putValue(blob, state.I, 2);
+	putValue(blob, state.pc, 2);
+	putValue(blob, state.sp, 2);
+
+	putBytes(blob, state.V, sizeof(state.V));
+	putBytes(blob, state.key, sizeof(state.key));
+
+	putValue(blob, state.delayTimer, 1);
+	putValue(blob, state.soundTimer, 1);
+	putValue(blob, state.keyWait, 1);
+}
+
+bool deserializeState(const unsigned char *blob, size_t length, Chip8State& state)
+{
+	StateReader reader(blob, length);
+
+	unsigned char magic[sizeof(STATE_MAGIC)];
+	unsigned short version, width, height;
+	if (!reader.getBytes(magic, sizeof(magic)) || memcmp(magic, STATE_MAGIC, sizeof(magic)) != 0 ||
+		!reader.get(version) || version != STATE_VERSION ||
+		!reader.get(width) || width != SCREEN_WIDTH ||
+		!reader.get(height) || height != SCREEN_HEIGHT)
+		return false;
+
+	// Read into a copy so a bad blob doesn't leave half a state behind
+	Chip8State read;
+	bool ok = reader.getBytes(read.memory, sizeof(read.memory));
+
+	for (unsigned int y = 0; y < SCREEN_HEIGHT; ++y)
+		for (unsigned int word = 0; word < SCREEN_ROW_WORDS; ++word)
+			ok = ok && reader.get(read.gfx[y][word]);
+
+	ok = ok && reader.get(read.cycleCount) && reader.get(read.idleCycles) &&
+		reader.get(read.frameCycle) && reader.get(read.randomState);
+
+	for (int i = 0; i < 16; ++i)
+		ok = ok && reader.get(read.stack[i]);
+
+	ok = ok && reader.get(read.I) && reader.get(read.pc) && reader.get(read.sp) &&
+		reader.getBytes(read.V, sizeof(read.V)) && reader.getBytes(read.key, sizeof(read.key)) &&
+		reader.get(read.delayTimer) && reader.get(read.soundTimer) && reader.get(read.keyWait);
+
+	// The stack pointer indexes the 16 entry stack
+	if (!ok || !reader.atEnd() || read.sp > 16 || read.keyWait > 1)
+		return false;
+
+	state = read;
+	return true;
+}
@@ -0,0 +1,49 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name: Chip 8 Interpreter
+//
+// Author: Jonathan Del Corpo
+// Contact: jonathan_delcorpo@hotmail.com
+//
+// License: GNU General Public License (GPL) v2 
+// ( http://www.gnu.org/licenses/old-licenses/gpl-2.0.html )
+//
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <cstddef>
+#include <vector>
+#include <type_traits>
+#include "Screen.h"
+
+//Complete machine state saved by Chip8::saveState, everything a game can read or change
+//Plain data aligned to a cache line, so copying a snapshot is a single memcpy and no pointers need fixing up.
+//Settings that aren't part of the machine (core, cycles per frame, screen edge, idle skipping) aren't saved.
+struct alignas(64) Chip8State
+{
+	unsigned char memory[4096];
+	unsigned long long gfx[SCREEN_HEIGHT][SCREEN_ROW_WORDS];
+	unsigned long long cycleCount;
+	unsigned long long idleCycles;
+	unsigned int frameCycle;
+	unsigned int randomState;
+	unsigned short stack[16];
+	unsigned short I;
+	unsigned short pc;
+	unsigned short sp;
+	unsigned char V[16];
+	unsigned char key[16];
+	unsigned char delayTimer;
+	unsigned char soundTimer;
+	unsigned char keyWait;
+};
+
+static_assert(std::is_trivially_copyable<Chip8State>::value, "Chip8State must be copyable with memcpy");
+
+//Version written in the serialized state, bumped whenever the layout of the blob changes
+const unsigned short STATE_VERSION = 1;
+
+//Append the state as a versioned little endian blob, the same on every host
+void serializeState(const Chip8State& state, std::vector<unsigned char>& blob);
+
+//Read a blob written by serializeState
+//Returns false and leaves state unchanged if the blob is truncated, from another version or screen size, or invalid
+bool deserializeState(const unsigned char *blob, size_t length, Chip8State& state);
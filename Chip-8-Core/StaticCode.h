@@ -0,0 +1,32 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name: Chip 8 Interpreter
+//
+// Author: Jonathan Del Corpo
+// Contact: jonathan_delcorpo@hotmail.com
+//
+// License: GNU General Public License (GPL) v2 
+// ( http://www.gnu.org/licenses/old-licenses/gpl-2.0.html )
+//
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "Chip8.h"
+
+//Access to the Chip8 state for the C++ files generated by -recompile
+struct StaticCode
+{
+	static unsigned char *V(Chip8& chip8) { return chip8.V; }
+
+	static unsigned short& I(Chip8& chip8) { return chip8.I; }
+
+	static unsigned short& pc(Chip8& chip8) { return chip8.pc; }
+
+	static unsigned char& delayTimer(Chip8& chip8) { return chip8.delay_timer; }
+
+	static unsigned char& soundTimer(Chip8& chip8) { return chip8.sound_timer; }
+
+	//Count the opcode, the timers tick once per frame in tickTimers
+	static void endCycle(Chip8& chip8) { chip8.endCycle(); }
+
+	//Run an opcode that isn't inlined in the interpreter, the program counter must point at it
+	static void execute(Chip8& chip8, unsigned short opcode) { chip8.executeOpcode(opcode); }
+};
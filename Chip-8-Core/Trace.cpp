@@ -0,0 +1,113 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name: Chip 8 Interpreter
+//
+// Author: Jonathan Del Corpo
+// Contact: jonathan_delcorpo@hotmail.com
+//
+// License: GNU General Public License (GPL) v2 
+// ( http://www.gnu.org/licenses/old-licenses/gpl-2.0.html )
+//
+///////////////////////////////////////////////////////////////////////////////
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+#include "Trace.h"
+
+SignalSafeWriter::SignalSafeWriter(int fd) : fd(fd), length(0) {}
+
+SignalSafeWriter::~SignalSafeWriter()
+{
+	flush();
+}
+
+void SignalSafeWriter::text(const char *s)
+{
+	while (*s)
+		put(*s++);
+}
+
+void SignalSafeWriter::decimal(unsigned long long value)
+{
+	char digits[20];
+	int count = 0;
+	do
+	{
+		digits[count++] = (char)('0' + value % 10);
+		value /= 10;
+	} while (value != 0);
+
+	while (count > 0)
+		put(digits[--count]);
+}
+
+void SignalSafeWriter::hex(unsigned int value, int width)
+{
+	// Like %0*X, wider values keep all their digits
+	while (width < 8 && (value >> (width * 4)) != 0)
+		++width;
+
+	for (int shift = (width - 1) * 4; shift >= 0; shift -= 4)
+		put("0123456789ABCDEF"[(value >> shift) & 0xF]);
+}
+
+void SignalSafeWriter::put(char c)
+{
+	if (length == sizeof(buffer))
+		flush();
+	buffer[length++] = c;
+}
+
+void SignalSafeWriter::flush()
+{
+#ifdef _WIN32
+	_write(fd, buffer, length);
+#else
+	ssize_t written = write(fd, buffer, length);
+	(void)written;
+#endif
+	length = 0;
+}
+
+Trace::Trace() : next(0) {}
+
+void Trace::dump(FILE *file) const
+{
+	unsigned long long first = next > TRACE_SIZE ? next - TRACE_SIZE : 0;
+
+	fprintf(file, "Last %llu opcodes:\n", next - first);
+	for (unsigned long long i = first; i < next; ++i)
+	{
+		const TraceRecord& r = records[i & (TRACE_SIZE - 1)];
+		fprintf(file, "cycle: %llu pc: 0x%03X opcode: %04X\n", r.cycle, r.pc, r.opcode);
+	}
+}
+
+void Trace::writeDump(int fd) const
+{
+	unsigned long long last = next;
+	unsigned long long first = last > TRACE_SIZE ? last - TRACE_SIZE : 0;
+
+	SignalSafeWriter out(fd);
+	out.text("Last ");
+	out.decimal(last - first);
+	out.text(" opcodes:\n");
+
+	for (unsigned long long i = first; i < last; ++i)
+	{
+		const TraceRecord& r = records[i & (TRACE_SIZE - 1)];
+		out.text("cycle: ");
+		out.decimal(r.cycle);
+		out.text(" pc: 0x");
+		out.hex(r.pc, 3);
+		out.text(" opcode: ");
+		out.hex(r.opcode, 4);
+		out.text("\n");
+	}
+}
+
+void Trace::clear()
+{
+	next = 0;
+}
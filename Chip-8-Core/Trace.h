@@ -0,0 +1,95 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name: Chip 8 Interpreter
+//
+// Author: Jonathan Del Corpo
+// Contact: jonathan_delcorpo@hotmail.com
+//
+// License: GNU General Public License (GPL) v2 
+// ( http://www.gnu.org/licenses/old-licenses/gpl-2.0.html )
+//
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <cstdio>
+
+//Trace level, set it in the preprocessor definitions of the project
+//0 - no tracing, the trace calls compile to nothing
+//1 - the last TRACE_SIZE opcodes are kept in memory for dumpTrace
+//2 - like 1 and every opcode is also printed as it runs
+#ifndef CHIP8_TRACE_LEVEL
+#define CHIP8_TRACE_LEVEL 0
+#endif
+
+//Number of opcodes kept, must be a power of 2
+const unsigned int TRACE_SIZE = 4096;
+
+//Opcode executed at pc, cycle is the number of opcodes executed before it
+struct TraceRecord
+{
+	unsigned long long cycle;
+	unsigned short pc;
+	unsigned short opcode;
+};
+
+//Formats text into a fixed buffer and writes it to a file descriptor when full or destroyed
+//Only uses write, so unlike printf it can be used in a signal handler
+class SignalSafeWriter
+{
+public:
+	SignalSafeWriter(int fd);
+	~SignalSafeWriter();
+
+	void text(const char *s);
+	void decimal(unsigned long long value);
+
+	//Upper case, padded with zeros to width digits
+	void hex(unsigned int value, int width);
+
+private:
+	void put(char c);
+	void flush();
+
+	int fd;
+	unsigned int length;
+	char buffer[1024];
+};
+
+//Ring buffer of the last TRACE_SIZE opcodes executed
+class Trace
+{
+public:
+	Trace();
+
+	void record(unsigned short pc, unsigned short opcode, unsigned long long cycle)
+	{
+		TraceRecord& r = records[next & (TRACE_SIZE - 1)];
+		r.cycle = cycle;
+		r.pc = pc;
+		r.opcode = opcode;
+		++next;
+
+#if CHIP8_TRACE_LEVEL >= 2
+		printf("opcode: %X pc: %d\n", opcode, pc);
+#endif
+	}
+
+	//Print the records from oldest to newest
+	void dump(FILE *file) const;
+
+	//Same as dump with write on a file descriptor and no stdio or allocation, so a signal handler can call it
+	//The records are read while the emulator may still be writing them, the last few can be torn
+	void writeDump(int fd) const;
+
+	void clear();
+
+private:
+	TraceRecord records[TRACE_SIZE];
+
+	//Number of records ever written
+	unsigned long long next;
+};
+
+#if CHIP8_TRACE_LEVEL >= 1
+#define CHIP8_TRACE(trace, pc, opcode, cycle) (trace).record((pc), (opcode), (cycle))
+#else
+#define CHIP8_TRACE(trace, pc, opcode, cycle) ((void)0)
+#endif
@@ -0,0 +1,41 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name: Chip 8 Interpreter
+//
+// Author: Jonathan Del Corpo
+// Contact: jonathan_delcorpo@hotmail.com
+//
+// License: GNU General Public License (GPL) v2 
+// ( http://www.gnu.org/licenses/old-licenses/gpl-2.0.html )
+//
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+
+//Reads a whole command line argument as a decimal number
+//Returns false for empty text, signs, trailing characters or numbers too large for value
+inline bool parseNumber(const char *text, unsigned long long& value)
+{
+	if (*text < '0' || *text > '9')
+		return false;
+
+	char *end;
+	errno = 0;
+	unsigned long long parsed = strtoull(text, &end, 10);
+	if (*end != '\0' || errno == ERANGE)
+		return false;
+
+	value = parsed;
+	return true;
+}
+
+inline bool parseNumber(const char *text, unsigned int& value)
+{
+	unsigned long long parsed;
+	if (!parseNumber(text, parsed) || parsed > UINT_MAX)
+		return false;
+
+	value = (unsigned int)parsed;
+	return true;
+}
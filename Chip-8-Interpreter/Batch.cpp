@@ -0,0 +1,227 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name: Chip 8 Interpreter
+//
+// Author: Jonathan Del Corpo
+// Contact: jonathan_delcorpo@hotmail.com
+//
+// License: GNU General Public License (GPL) v2 
+// ( http://www.gnu.org/licenses/old-licenses/gpl-2.0.html )
+//
+///////////////////////////////////////////////////////////////////////////////
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+#include "Arguments.h"
+#include "Batch.h"
+#include "ThreadPool.h"
+
+int runBatch(int argc, char *argv[])
+{
+	unsigned int frames = DEFAULT_BATCH_FRAMES;
+	unsigned int threads = 0;
+	unsigned int seed = 1;
+	unsigned int runs = 1;
+	ScreenEdge edge = EDGE_CLIP;
+	std::string scriptPath;
+	std::vector<std::string> games;
+
+	bool valid = true;
+
+	for (int i = 0; i < argc && valid; ++i)
+	{
+		std::string arg(argv[i]);
+		if (arg == "-frames" && i + 1 < argc)
+			valid = parseNumber(argv[++i], frames);
+		else if (arg == "-script" && i + 1 < argc)
+			scriptPath = argv[++i];
+		else if (arg == "-threads" && i + 1 < argc)
+			valid = parseNumber(argv[++i], threads);
+		else if (arg == "-seed" && i + 1 < argc)
+			valid = parseNumber(argv[++i], seed);
+		else if (arg == "-runs" && i + 1 < argc)
+		{
+			valid = parseNumber(argv[++i], runs);
+			runs = std::max(1U, runs);
+		}
+		else if (arg == "-wrap")
+			edge = EDGE_WRAP;
+		else
+		{
+			// A directory adds every file in it
+			std::vector<std::string> files = listDirectory(arg);
+			if (files.empty())
+				games.push_back(arg);
+			else
+				games.insert(games.end(), files.begin(), files.end());
+		}
+	}
+
+	if (!valid || games.empty())
+	{
+		printf("Usage: -batch [-frames N] [-script file] [-threads N] [-seed N] [-runs N] [-wrap] rom_or_directory ...\n");
+		return 1;
+	}
+
+	std::vector<ScriptEvent> events;
+	if (!scriptPath.empty() && !loadScript(scriptPath, events))
+	{
+		printf("Can't read script %s\n", scriptPath.c_str());
+		return 1;
+	}
+
+	// Run n of a ROM uses seed + n
+	std::vector<BatchResult> results(games.size() * runs);
+	for (size_t i = 0; i < results.size(); ++i)
+	{
+		results[i].gamePath = games[i / runs];
+		results[i].run = (unsigned int)(i % runs);
+	}
+
+	// Every run of a ROM, and every ROM with the same contents, shares one read and decoded image
+	RomCache cache;
+
+	ThreadPool pool(threads);
+
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+	// Every run gets its own Chip8 and result, only the read only ROM images are shared between jobs
+	pool.run(results.size(), [&](size_t i)
+	{
+		runBatchRom(results[i], cache, events, frames, seed + results[i].run, edge);
+	});
+
+	std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+	int failed = 0;
+	for (size_t i = 0; i < results.size(); ++i)
+	{
+		const BatchResult& result = results[i];
+
+		std::string name = result.gamePath;
+		if (runs > 1)
+			name += " #" + std::to_string(result.run);
+
+		if (result.loadResult != Chip8::LOAD_OK)
+		{
+			printf("%-32s %s\n", name.c_str(), Chip8::describeLoadResult(result.loadResult));
+			++failed;
+			continue;
+		}
+
+		printf("%-32s %016llx %14llu cycles %10.2f ms\n",
+			name.c_str(), result.screenHash, result.cycles, result.milliseconds);
+	}
+
+	printf("%u ROMs, %u runs of %u frames each, %u threads, %.2f s\n",
+		(unsigned int)games.size(), runs, frames, pool.threadCount(), elapsed.count());
+
+	return failed == 0 ? 0 : 1;
+}
+
+bool loadScript(const std::string& path, std::vector<ScriptEvent>& events)
+{
+	std::ifstream file(path);
+	if (!file)
+		return false;
+
+	std::string line;
+	while (std::getline(file, line))
+	{
+		if (line.empty() || line[0] == '#')
+			continue;
+
+		std::istringstream fields(line);
+		unsigned int frame, key, value;
+		if (!(fields >> std::dec >> frame >> std::hex >> key >> std::dec >> value) || key > 0xF)
+			return false;
+
+		ScriptEvent event = { frame, (unsigned char)key, (unsigned char)(value != 0) };
+		events.push_back(event);
+	}
+
+	// Events on the same frame keep the order they were written in
+	std::stable_sort(events.begin(), events.end(), [](const ScriptEvent& a, const ScriptEvent& b)
+	{
+		return a.frame < b.frame;
+	});
+
+	return true;
+}
+
+void runBatchRom(BatchResult& result, RomCache& cache, const std::vector<ScriptEvent>& events, unsigned int frames,
+	unsigned int seed, ScreenEdge edge)
+{
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+	// Too big for the stack of a worker thread
+	std::unique_ptr<Chip8> chip8(new Chip8);
+	chip8->initialize();
+	chip8->setSeed(seed);
+	chip8->setScreenEdge(edge);
+
+	std::shared_ptr<const RomImage> image;
+	result.loadResult = cache.get(result.gamePath, image);
+	if (result.loadResult != Chip8::LOAD_OK)
+		return;
+
+	chip8->loadGame(image);
+
+	size_t next = 0;
+	for (unsigned int frame = 0; frame < frames; ++frame)
+	{
+		for (; next < events.size() && events[next].frame == frame; ++next)
+			chip8->key[events[next].key] = events[next].value;
+
+		chip8->runFrame();
+	}
+
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+	result.screenHash = chip8->hashScreen();
+	result.cycles = chip8->getCycleCount();
+	result.milliseconds = elapsed.count();
+}
+
+std::vector<std::string> listDirectory(const std::string& path)
+{
+	std::vector<std::string> files;
+
+#ifdef _WIN32
+	WIN32_FIND_DATAA found;
+	HANDLE find = FindFirstFileA((path + "\\*").c_str(), &found);
+	if (find == INVALID_HANDLE_VALUE)
+		return files;
+
+	do
+	{
+		if (!(found.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+			files.push_back(path + "\\" + found.cFileName);
+	} while (FindNextFileA(find, &found));
+
+	FindClose(find);
+#else
+	DIR *dir = opendir(path.c_str());
+	if (dir == NULL)
+		return files;
+
+	while (dirent *entry = readdir(dir))
+	{
+		std::string file = path + "/" + entry->d_name;
+		struct stat info;
+		if (stat(file.c_str(), &info) == 0 && S_ISREG(info.st_mode))
+			files.push_back(file);
+	}
+
+	closedir(dir);
+#endif
+
+	std::sort(files.begin(), files.end());
+	return files;
+}
@@ -0,0 +1,50 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name: Chip 8 Interpreter
+//
+// Author: Jonathan Del Corpo
+// Contact: jonathan_delcorpo@hotmail.com
+//
+// License: GNU General Public License (GPL) v2 
+// ( http://www.gnu.org/licenses/old-licenses/gpl-2.0.html )
+//
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <string>
+#include <vector>
+#include "Chip8.h"
+#include "RomCache.h"
+
+//Frames each ROM runs for when none is given, one minute at 60 frames per second
+const unsigned int DEFAULT_BATCH_FRAMES = 3600;
+
+//Runs every ROM headless on all hardware threads and prints the screen hash, cycles and time of each
+//Usage: -batch [-frames N] [-script file] [-threads N] [-seed N] [-runs N] [-wrap] rom_or_directory ...
+int runBatch(int argc, char *argv[]);
+
+//Key press or release applied before a frame runs
+struct ScriptEvent
+{
+	unsigned int frame;
+	unsigned char key;		//0x0 - 0xF
+	unsigned char value;	//1 pressed, 0 released
+};
+
+//Input script line: frame key value, with key in hex, lines starting with # are ignored
+//Example: "120 5 1" presses key 5 before frame 120
+bool loadScript(const std::string& path, std::vector<ScriptEvent>& events);
+
+struct BatchResult
+{
+	std::string gamePath;
+	unsigned int run;				//0 to runs - 1, the seed is the batch seed + run
+	Chip8::LoadResult loadResult;
+	unsigned long long screenHash;	//Chip8::hashScreen of the final screen
+	unsigned long long cycles;
+	double milliseconds;
+};
+
+void runBatchRom(BatchResult& result, RomCache& cache, const std::vector<ScriptEvent>& events, unsigned int frames,
+	unsigned int seed, ScreenEdge edge);
+
+//Files directly in the directory, sorted by name
+std::vector<std::string> listDirectory(const std::string& path);
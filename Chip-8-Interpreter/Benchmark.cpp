@@ -0,0 +1,130 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name: Chip 8 Interpreter
+//
+// Author: Jonathan Del Corpo
+// Contact: jonathan_delcorpo@hotmail.com
+//
+// License: GNU General Public License (GPL) v2 
+// ( http://www.gnu.org/licenses/old-licenses/gpl-2.0.html )
+//
+///////////////////////////////////////////////////////////////////////////////
+#include <chrono>
+#include "Arguments.h"
+#include "Benchmark.h"
+#include "Lockstep.h"
+
+const BenchmarkCore BENCHMARK_CORES[] =
+{
+	{ Chip8::CORE_SWITCH, "switch" },
+	{ Chip8::CORE_TABLE, "table" },
+	{ Chip8::CORE_CACHED, "cached" },
+	{ Chip8::CORE_BLOCK, "block" },
+	{ Chip8::CORE_JIT, "jit" },
+	{ Chip8::CORE_STATIC, "static" },
+	{ Chip8::CORE_THREADED, "threaded" }
+};
+
+const size_t BENCHMARK_CORE_COUNT = sizeof(BENCHMARK_CORES) / sizeof(BENCHMARK_CORES[0]);
+
+int runBenchmark(int argc, char *argv[])
+{
+	unsigned long long cycles = DEFAULT_BENCHMARK_CYCLES;
+	std::vector<std::string> games;
+
+	bool valid = true;
+
+	for (int i = 0; i < argc && valid; ++i)
+	{
+		std::string arg(argv[i]);
+		if (arg == "-cycles" && i + 1 < argc)
+			valid = parseNumber(argv[++i], cycles);
+		else
+			games.push_back(arg);
+	}
+
+	if (!valid || games.empty())
+	{
+		printf("Usage: -bench [-cycles N] rom1 rom2 ...\n");
+		return 1;
+	}
+
+	Chip8 chip8;
+
+	for (size_t i = 0; i < games.size(); ++i)
+	{
+		Chip8::LoadResult loaded = chip8.loadGame(games[i]);
+		if (loaded != Chip8::LOAD_OK)
+		{
+			printf("%-24s %s\n", games[i].c_str(), Chip8::describeLoadResult(loaded));
+			continue;
+		}
+
+		double baseline = 0.0;
+		for (size_t j = 0; j < BENCHMARK_CORE_COUNT; ++j)
+		{
+			double speed = benchmarkCore(chip8, BENCHMARK_CORES[j].core, games[i], cycles);
+			if (j == 0)
+				baseline = speed;
+
+			printf("%-24s %-10s %14.0f instructions/s (x%.2f)\n",
+				games[i].c_str(), BENCHMARK_CORES[j].name, speed, speed / baseline);
+		}
+
+		// Same number of instructions shared out over the lanes
+		double speeds[] =
+		{
+			benchmarkLockstep<8>(games[i], cycles),
+			benchmarkLockstep<16>(games[i], cycles),
+			benchmarkLockstep<32>(games[i], cycles)
+		};
+		const char *names[] = { "lockstep8", "lockstep16", "lockstep32" };
+
+		for (int j = 0; j < 3; ++j)
+			printf("%-24s %-10s %14.0f instructions/s (x%.2f)\n",
+				games[i].c_str(), names[j], speeds[j], speeds[j] / baseline);
+	}
+
+	return 0;
+}
+
+//Returns the number of instructions per second the core executed
+double benchmarkCore(Chip8& chip8, Chip8::Core core, const std::string& gamePath, unsigned long long cycles)
+{
+	chip8.initialize();
+	chip8.setCore(core);
+	chip8.loadGame(gamePath);
+
+	//Skipped idle loops would count as executed instructions
+	chip8.setIdleSkipping(false);
+
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+	//Frame by frame so the timers tick and games waiting on the delay timer get past the wait
+	unsigned long long frames = cycles / DEFAULT_CYCLES_PER_FRAME;
+	for (unsigned long long i = 0; i < frames; ++i)
+		chip8.runFrame();
+
+	std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+	return (double)chip8.getCycleCount() / elapsed.count();
+}
+
+//Returns the number of instructions per second executed over all the lanes
+template <unsigned int LANES>
+double benchmarkLockstep(const std::string& gamePath, unsigned long long cycles)
+{
+	std::unique_ptr<Lockstep<LANES>> lockstep(new Lockstep<LANES>);
+	lockstep->initialize();
+	lockstep->loadGame(gamePath);
+
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+	//Frame by frame like benchmarkCore
+	unsigned long long frames = cycles / LANES / DEFAULT_CYCLES_PER_FRAME;
+	for (unsigned long long i = 0; i < frames; ++i)
+		lockstep->runFrame();
+
+	std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+	return (double)(lockstep->getCycleCount() * LANES) / elapsed.count();
+}
@@ -0,0 +1,37 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name: Chip 8 Interpreter
+//
+// Author: Jonathan Del Corpo
+// Contact: jonathan_delcorpo@hotmail.com
+//
+// License: GNU General Public License (GPL) v2 
+// ( http://www.gnu.org/licenses/old-licenses/gpl-2.0.html )
+//
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <string>
+#include <vector>
+#include "Chip8.h"
+
+//Number of instructions executed per ROM and per core when none is given
+const unsigned long long DEFAULT_BENCHMARK_CYCLES = 10000000;
+
+struct BenchmarkCore
+{
+	Chip8::Core core;
+	const char *name;
+};
+
+//Every CPU core with the name printed for it, CORE_SWITCH comes first since the others are compared to it
+extern const BenchmarkCore BENCHMARK_CORES[];
+extern const size_t BENCHMARK_CORE_COUNT;
+
+//Runs every ROM headless on each CPU core and prints the instructions per second
+//Usage: -bench [-cycles N] rom1 rom2 ...
+int runBenchmark(int argc, char *argv[]);
+
+double benchmarkCore(Chip8& chip8, Chip8::Core core, const std::string& gamePath, unsigned long long cycles);
+
+//Runs LANES copies of the ROM with Lockstep
+template <unsigned int LANES>
+double benchmarkLockstep(const std::string& gamePath, unsigned long long cycles);
@@ -0,0 +1,151 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name: Chip 8 Interpreter
+//
+// Author: Jonathan Del Corpo
+// Contact: jonathan_delcorpo@hotmail.com
+//
+// License: GNU General Public License (GPL) v2 
+// ( http://www.gnu.org/licenses/old-licenses/gpl-2.0.html )
+//
+///////////////////////////////////////////////////////////////////////////////
+#include <memory>
+#include "Arguments.h"
+#include "Benchmark.h"
+#include "Conformance.h"
+
+//Seed of both copies, RND must give the same numbers on every core
+const unsigned int CONFORMANCE_SEED = 1;
+
+int runConformance(int argc, char *argv[])
+{
+	unsigned int frames = DEFAULT_CONFORMANCE_FRAMES;
+	std::string scriptPath;
+	std::vector<std::string> games;
+	bool valid = true;
+
+	for (int i = 0; i < argc && valid; ++i)
+	{
+		std::string arg(argv[i]);
+		if (arg == "-frames" && i + 1 < argc)
+			valid = parseNumber(argv[++i], frames);
+		else if (arg == "-script" && i + 1 < argc)
+			scriptPath = argv[++i];
+		else
+			games.push_back(arg);
+	}
+
+	if (!valid || games.empty())
+	{
+		printf("Usage: -conformance [-frames N] [-script file] rom1 rom2 ...\n");
+		return 1;
+	}
+
+	std::vector<ScriptEvent> events;
+	if (scriptPath.empty())
+		defaultConformanceScript(frames, events);
+	else if (!loadScript(scriptPath, events))
+	{
+		printf("Can't read script %s\n", scriptPath.c_str());
+		return 1;
+	}
+
+	// Too big for the stack next to the two copies compareCore runs
+	std::unique_ptr<Chip8> chip8(new Chip8);
+	chip8->initialize();
+
+	int failed = 0;
+	for (size_t i = 0; i < games.size(); ++i)
+	{
+		Chip8::LoadResult loaded = chip8->loadGame(games[i]);
+		if (loaded != Chip8::LOAD_OK)
+		{
+			printf("%-24s %s\n", games[i].c_str(), Chip8::describeLoadResult(loaded));
+			++failed;
+			continue;
+		}
+
+		// The first core is CORE_SWITCH itself
+		for (size_t j = 1; j < BENCHMARK_CORE_COUNT; ++j)
+		{
+			for (int idleSkipping = 1; idleSkipping >= 0; --idleSkipping)
+			{
+				unsigned int frame = compareCore(games[i], BENCHMARK_CORES[j].core, idleSkipping != 0, events, frames);
+				const char *idle = idleSkipping ? "idle skipping" : "no idle skipping";
+
+				if (frame == frames)
+				{
+					printf("%-24s %-10s %-18s same for %u frames\n", games[i].c_str(), BENCHMARK_CORES[j].name, idle, frames);
+				}
+				else
+				{
+					printf("%-24s %-10s %-18s differs at frame %u\n", games[i].c_str(), BENCHMARK_CORES[j].name, idle, frame);
+					++failed;
+				}
+			}
+		}
+	}
+
+	return failed != 0 ? 1 : 0;
+}
+
+void defaultConformanceScript(unsigned int frames, std::vector<ScriptEvent>& events)
+{
+	events.clear();
+
+	for (unsigned int frame = 30; frame < frames; frame += 60)
+	{
+		unsigned char key = (unsigned char)((frame / 60) % 16);
+		ScriptEvent press = { frame, key, 1 };
+		ScriptEvent release = { frame + 6, key, 0 };
+		events.push_back(press);
+		events.push_back(release);
+	}
+}
+
+unsigned int compareCore(const std::string& gamePath, Chip8::Core core, bool idleSkipping,
+	const std::vector<ScriptEvent>& events, unsigned int frames)
+{
+	std::unique_ptr<Chip8> reference(new Chip8);
+	std::unique_ptr<Chip8> tested(new Chip8);
+	Chip8 *chips[] = { reference.get(), tested.get() };
+
+	for (int i = 0; i < 2; ++i)
+	{
+		chips[i]->initialize();
+		chips[i]->setCore(i == 0 ? Chip8::CORE_SWITCH : core);
+		chips[i]->setSeed(CONFORMANCE_SEED);
+		chips[i]->setIdleSkipping(idleSkipping);
+		chips[i]->loadGame(gamePath);
+	}
+
+	Chip8State state;
+	std::vector<unsigned char> expected;
+	std::vector<unsigned char> actual;
+
+	size_t next = 0;
+	for (unsigned int frame = 0; frame < frames; ++frame)
+	{
+		for (; next < events.size() && events[next].frame == frame; ++next)
+		{
+			reference->key[events[next].key] = events[next].value;
+			tested->key[events[next].key] = events[next].value;
+		}
+
+		reference->runFrame();
+		tested->runFrame();
+
+		// The versioned blob covers memory, screen, registers, timers and cycle counts
+		expected.clear();
+		reference->saveState(state);
+		serializeState(state, expected);
+
+		actual.clear();
+		tested->saveState(state);
+		serializeState(state, actual);
+
+		if (expected != actual)
+			return frame;
+	}
+
+	return frames;
+}
@@ -0,0 +1,31 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name: Chip 8 Interpreter
+//
+// Author: Jonathan Del Corpo
+// Contact: jonathan_delcorpo@hotmail.com
+//
+// License: GNU General Public License (GPL) v2 
+// ( http://www.gnu.org/licenses/old-licenses/gpl-2.0.html )
+//
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <string>
+#include <vector>
+#include "Chip8.h"
+#include "Batch.h"
+
+//Frames each ROM runs for when none is given, one minute at 60 frames per second
+const unsigned int DEFAULT_CONFORMANCE_FRAMES = 3600;
+
+//Runs every ROM headless on each CPU core next to CORE_SWITCH and compares the saved state after every frame
+//Prints the first frame a core differs at and returns 1 when any core differs or a ROM can't be loaded
+//Usage: -conformance [-frames N] [-script file] rom1 rom2 ...
+int runConformance(int argc, char *argv[]);
+
+//Key presses used without -script, every key in turn is held for a few frames once a second
+void defaultConformanceScript(unsigned int frames, std::vector<ScriptEvent>& events);
+
+//Frame the core first ends with a state different from CORE_SWITCH, frames when it never does
+//Both run with the same seed and key presses, with idle loop skipping on or off
+unsigned int compareCore(const std::string& gamePath, Chip8::Core core, bool idleSkipping,
+	const std::vector<ScriptEvent>& events, unsigned int frames);
@@ -0,0 +1,91 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name: Chip 8 Interpreter
+//
+// Author: Jonathan Del Corpo
+// Contact: jonathan_delcorpo@hotmail.com
+//
+// License: GNU General Public License (GPL) v2 
+// ( http://www.gnu.org/licenses/old-licenses/gpl-2.0.html )
+//
+///////////////////////////////////////////////////////////////////////////////
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include "KeyMap.h"
+
+KeyMap::KeyMap()
+{
+	setDefault();
+}
+
+void KeyMap::setDefault()
+{
+	static const SDL_Scancode DEFAULT_LAYOUT[16] =
+	{
+		SDL_SCANCODE_X,		//0
+		SDL_SCANCODE_1,		//1
+		SDL_SCANCODE_2,		//2
+		SDL_SCANCODE_3,		//3
+		SDL_SCANCODE_Q,		//4
+		SDL_SCANCODE_W,		//5
+		SDL_SCANCODE_E,		//6
+		SDL_SCANCODE_A,		//7
+		SDL_SCANCODE_S,		//8
+		SDL_SCANCODE_D,		//9
+		SDL_SCANCODE_Z,		//A
+		SDL_SCANCODE_C,		//B
+		SDL_SCANCODE_4,		//C
+		SDL_SCANCODE_R,		//D
+		SDL_SCANCODE_F,		//E
+		SDL_SCANCODE_V		//F
+	};
+
+	memset(keys, NO_KEY, sizeof(keys));
+
+	for (unsigned char key = 0; key < 16; key++)
+		keys[DEFAULT_LAYOUT[key]] = key;
+}
+
+bool KeyMap::load(const std::string& path)
+{
+	std::ifstream file(path);
+	if (!file)
+		return false;
+
+	unsigned char loaded[SDL_NUM_SCANCODES];
+	memset(loaded, NO_KEY, sizeof(loaded));
+
+	std::string line;
+	while (std::getline(file, line))
+	{
+		// Files saved on Windows end their lines with \r
+		if (!line.empty() && line[line.size() - 1] == '\r')
+			line.erase(line.size() - 1);
+
+		if (line.empty() || line[0] == '#')
+			continue;
+
+		// The key name is everything after the first space, names like "Left Shift" contain spaces
+		size_t space = line.find(' ');
+		if (space == std::string::npos)
+			return false;
+
+		char *end;
+		unsigned long key = strtoul(line.substr(0, space).c_str(), &end, 16);
+		if (*end != '\0' || key > 0xF)
+			return false;
+
+		size_t name = line.find_first_not_of(' ', space);
+		if (name == std::string::npos)
+			return false;
+
+		SDL_Scancode scancode = SDL_GetScancodeFromName(line.c_str() + name);
+		if (scancode == SDL_SCANCODE_UNKNOWN)
+			return false;
+
+		loaded[scancode] = (unsigned char)key;
+	}
+
+	memcpy(keys, loaded, sizeof(keys));
+	return true;
+}
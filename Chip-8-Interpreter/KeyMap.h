@@ -0,0 +1,46 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name: Chip 8 Interpreter
+//
+// Author: Jonathan Del Corpo
+// Contact: jonathan_delcorpo@hotmail.com
+//
+// License: GNU General Public License (GPL) v2 
+// ( http://www.gnu.org/licenses/old-licenses/gpl-2.0.html )
+//
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <string>
+#include <SDL.h>
+
+//Translates SDL scancodes to Chip8 keys through a table indexed by scancode
+//Scancodes are physical key positions, so the default layout is the same on every keyboard layout
+class KeyMap
+{
+public:
+	//Table value of scancodes that aren't mapped to a Chip8 key
+	static const unsigned char NO_KEY = 0xFF;
+
+	//Starts with the default layout
+	KeyMap();
+
+	//The usual layout on the left side of the keyboard:
+	//1 2 3 4      1 2 3 C
+	//Q W E R  ->  4 5 6 D
+	//A S D F      7 8 9 E
+	//Z X C V      A 0 B F
+	void setDefault();
+
+	//Replaces the layout with the one in the file, one "chip8_key(hex) key_name" line per mapping
+	//Key names are the SDL names ("Q", "Space", "Keypad 5"), lines starting with # are comments
+	//Returns false and keeps the current layout if the file can't be read or has an invalid line
+	bool load(const std::string& path);
+
+	//Chip8 key of the scancode, NO_KEY when it isn't mapped
+	unsigned char lookup(SDL_Scancode scancode) const
+	{
+		return (unsigned int)scancode < SDL_NUM_SCANCODES ? keys[scancode] : NO_KEY;
+	}
+
+private:
+	unsigned char keys[SDL_NUM_SCANCODES];
+};
@@ -0,0 +1,351 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name: Chip 8 Interpreter
+//
+// Author: Jonathan Del Corpo
+// Contact: jonathan_delcorpo@hotmail.com
+//
+// License: GNU General Public License (GPL) v2 
+// ( http://www.gnu.org/licenses/old-licenses/gpl-2.0.html )
+//
+///////////////////////////////////////////////////////////////////////////////
+#include <regex>
+#include "Recompiler.h"
+#include "Chip8.h"
+
+int runRecompiler(int argc, char *argv[])
+{
+	if (argc != 2)
+	{
+		printf("Usage: -recompile rom output.cpp\n");
+		return 1;
+	}
+
+	std::string gamePath(argv[0]);
+	unsigned char buffer[Chip8::MAX_ROM_SIZE];
+	size_t length = 0;
+	Chip8::LoadResult loaded = Chip8::readRom(gamePath, buffer, length);
+	if (loaded != Chip8::LOAD_OK)
+	{
+		printf("%s: %s\n", gamePath.c_str(), Chip8::describeLoadResult(loaded));
+		return 1;
+	}
+
+	std::vector<unsigned char> rom(buffer, buffer + length);
+
+	// The file name without its directory and extension is used for the identifiers
+	std::string name = gamePath.substr(gamePath.find_last_of("/\\") + 1);
+	name = name.substr(0, name.find('.'));
+	name = std::regex_replace(name, std::regex("[^A-Za-z0-9_]"), "_");
+
+	Recompiler recompiler(rom);
+	recompiler.discover();
+
+	if (recompiler.blockCount() == 0 || !recompiler.write(argv[1], name))
+	{
+		printf("Can't recompile %s\n", gamePath.c_str());
+		return 1;
+	}
+
+	printf("Recompiled %u blocks of %s to %s\n", (unsigned int)recompiler.blockCount(), gamePath.c_str(), argv[1]);
+	return 0;
+}
+
+Recompiler::Recompiler(const std::vector<unsigned char>& rom) : rom(rom) {}
+
+void Recompiler::discover()
+{
+	std::vector<unsigned short> pending;
+	pending.push_back(0x200);
+
+	while (!pending.empty())
+	{
+		unsigned short address = pending.back();
+		pending.pop_back();
+
+		if (!inRom(address) || blocks.count(address) != 0 || !Chip8::knowsOpcode(fetch(address)))
+			continue;
+
+		Block block;
+		block.address = address;
+
+		unsigned int current = address;
+		for (;;)
+		{
+			unsigned short opcode = fetch(current);
+
+			// Probably data, let the interpreter deal with it if it is ever reached
+			if (!Chip8::knowsOpcode(opcode))
+				break;
+
+			block.opcodes.push_back(opcode);
+
+			unsigned short NNN = opcode & 0x0FFF;
+			switch (opcode & 0xF000)
+			{
+				//1nnn - JP addr
+			case 0x1000:
+				pending.push_back(NNN);
+				break;
+
+				//2nnn - CALL addr, RET comes back after the call
+			case 0x2000:
+				pending.push_back(NNN);
+				pending.push_back(current + 2);
+				break;
+
+				//Skips
+			case 0x3000:
+			case 0x4000:
+			case 0x5000:
+			case 0x9000:
+			case 0xE000:
+				pending.push_back(current + 2);
+				pending.push_back(current + 4);
+				break;
+
+				//00EE - RET goes back to an address pushed by a call
+			case 0x0000:
+				if ((opcode & 0x000F) != 0x000E)
+					pending.push_back(current + 2);
+				break;
+
+				//Bnnn - JP V0, addr can't be followed
+			case 0xB000:
+				break;
+
+				//DRW, Fx0A, Fx33 and Fx55 end the block but continue after it
+			default:
+				if (Chip8::opcodeEndsBlock(opcode))
+					pending.push_back(current + 2);
+				break;
+			}
+
+			current += 2;
+			if (Chip8::opcodeEndsBlock(opcode) || block.opcodes.size() == MAX_STATIC_BLOCK_LENGTH || !inRom(current))
+				break;
+		}
+
+		if (!block.opcodes.empty())
+			blocks[address] = block;
+	}
+}
+
+bool Recompiler::write(const std::string& path, const std::string& name)
+{
+	FILE *file = fopen(path.c_str(), "w");
+	if (file == NULL)
+		return false;
+
+	fprintf(file, "// Generated by Chip-8-Interpreter.exe -recompile from %s, do not edit\n", name.c_str());
+	fprintf(file, "#include \"StaticCode.h\"\n\n");
+	fprintf(file, "namespace\n{\n");
+
+	for (std::map<unsigned short, Block>::const_iterator it = blocks.begin(); it != blocks.end(); ++it)
+	{
+		const Block& block = it->second;
+
+		fprintf(file, "\tconst unsigned char bytes_%04X[] = {", block.address);
+		for (size_t i = 0; i < block.opcodes.size(); ++i)
+			fprintf(file, "%s0x%02X, 0x%02X", i == 0 ? " " : ", ", block.opcodes[i] >> 8, block.opcodes[i] & 0xFF);
+		fprintf(file, " };\n\n");
+
+		std::string body;
+		bool executed = false;
+		unsigned short address = block.address;
+		for (size_t i = 0; i < block.opcodes.size(); ++i, address += 2)
+		{
+			char comment[32];
+			sprintf(comment, "\t\t// 0x%03X: %04X\n", address, block.opcodes[i]);
+			body += comment;
+			body += "\t\t" + translate(address, block.opcodes[i], executed) + "\n";
+			if (!executed)
+				body += "\t\tStaticCode::endCycle(c);\n";
+		}
+
+		// The block was cut short, continue after it
+		if (!Chip8::opcodeEndsBlock(block.opcodes.back()) && !executed)
+		{
+			char next[32];
+			sprintf(next, "\t\tpc = 0x%03X;\n", address);
+			body += next;
+		}
+
+		fprintf(file, "\tvoid block_%04X(Chip8& c)\n\t{\n", block.address);
+		if (std::regex_search(body, std::regex("\\bV\\[")))
+			fprintf(file, "\t\tunsigned char *V = StaticCode::V(c);\n");
+		if (std::regex_search(body, std::regex("\\bI\\b")))
+			fprintf(file, "\t\tunsigned short& I = StaticCode::I(c);\n");
+		if (std::regex_search(body, std::regex("\\bpc\\b")))
+			fprintf(file, "\t\tunsigned short& pc = StaticCode::pc(c);\n");
+		if (std::regex_search(body, std::regex("\\bDT\\b")))
+			fprintf(file, "\t\tunsigned char& DT = StaticCode::delayTimer(c);\n");
+		if (std::regex_search(body, std::regex("\\bST\\b")))
+			fprintf(file, "\t\tunsigned char& ST = StaticCode::soundTimer(c);\n");
+		fprintf(file, "\n%s\t}\n\n", body.c_str());
+	}
+
+	fprintf(file, "\tconst StaticBlock blocks[] =\n\t{\n");
+	for (std::map<unsigned short, Block>::const_iterator it = blocks.begin(); it != blocks.end(); ++it)
+	{
+		const Block& block = it->second;
+
+		unsigned short pages = 0;
+		for (size_t i = 0; i < block.opcodes.size() * 2; ++i)
+			pages |= 1 << (((block.address + i) & 0xFFF) >> 8);
+
+		fprintf(file, "\t\t{ block_%04X, 0x%03X, %u, 0x%04X, bytes_%04X },\n",
+			block.address, block.address, (unsigned int)block.opcodes.size(), pages, block.address);
+	}
+	fprintf(file, "\t};\n\n");
+
+	fprintf(file, "\tconst StaticRom rom = { 0x%016llXULL, %u, blocks, sizeof(blocks) / sizeof(blocks[0]) };\n\n",
+		Chip8::hashRom(rom.data(), rom.size()), (unsigned int)rom.size());
+	fprintf(file, "\tconst bool registered = Chip8::registerStaticRom(&rom);\n");
+	fprintf(file, "}\n");
+
+	fclose(file);
+	return true;
+}
+
+size_t Recompiler::blockCount() const
+{
+	return blocks.size();
+}
+
+bool Recompiler::inRom(unsigned int address) const
+{
+	return address >= 0x200 && address + 1 < 0x200 + rom.size();
+}
+
+unsigned short Recompiler::fetch(unsigned short address) const
+{
+	return rom[address - 0x200] << 8 | rom[address + 1 - 0x200];
+}
+
+// C++ for one opcode, executed is set when the opcode is left to the interpreter
+// Flags are set before the result like the interpreter does
+std::string Recompiler::translate(unsigned short address, unsigned short opcode, bool& executed) const
+{
+	unsigned int X = (opcode & 0x0F00) >> 8;
+	unsigned int Y = (opcode & 0x00F0) >> 4;
+	unsigned int NN = opcode & 0x00FF;
+	unsigned int NNN = opcode & 0x0FFF;
+	unsigned int next = address + 2;
+	unsigned int skip = address + 4;
+
+	char line[160] = "";
+	executed = false;
+
+	switch (opcode & 0xF000)
+	{
+	case 0x1000:
+		sprintf(line, "pc = 0x%03X;", NNN);
+		break;
+
+	case 0x3000:
+		sprintf(line, "pc = V[0x%X] == 0x%02X ? 0x%03X : 0x%03X;", X, NN, skip, next);
+		break;
+
+	case 0x4000:
+		sprintf(line, "pc = V[0x%X] != 0x%02X ? 0x%03X : 0x%03X;", X, NN, skip, next);
+		break;
+
+	case 0x5000:
+		//A register always equals itself, comparing it would be a tautology warning in the generated code
+		if (X == Y)
+			sprintf(line, "pc = 0x%03X;", skip);
+		else
+			sprintf(line, "pc = V[0x%X] == V[0x%X] ? 0x%03X : 0x%03X;", X, Y, skip, next);
+		break;
+
+	case 0x6000:
+		sprintf(line, "V[0x%X] = 0x%02X;", X, NN);
+		break;
+
+	case 0x7000:
+		sprintf(line, "V[0x%X] += 0x%02X;", X, NN);
+		break;
+
+	case 0x8000:
+		switch (opcode & 0x000F)
+		{
+		case 0x0000:
+			sprintf(line, "V[0x%X] = V[0x%X];", X, Y);
+			break;
+		case 0x0001:
+			sprintf(line, "V[0x%X] |= V[0x%X];", X, Y);
+			break;
+		case 0x0002:
+			sprintf(line, "V[0x%X] &= V[0x%X];", X, Y);
+			break;
+		case 0x0003:
+			sprintf(line, "V[0x%X] ^= V[0x%X];", X, Y);
+			break;
+		case 0x0004:
+			sprintf(line, "V[0xF] = V[0x%X] + V[0x%X] > 0xF0 ? 1 : 0; V[0x%X] += V[0x%X];", X, Y, X, Y);
+			break;
+		case 0x0005:
+			//Vx > Vx never holds, the same as Chip8::SUB
+			if (X == Y)
+				sprintf(line, "V[0xF] = 0; V[0x%X] = 0;", X);
+			else
+				sprintf(line, "V[0xF] = V[0x%X] > V[0x%X] ? 1 : 0; V[0x%X] -= V[0x%X];", X, Y, X, Y);
+			break;
+		case 0x0006:
+			sprintf(line, "V[0xF] = V[0x%X] %% 2; V[0x%X] >>= 1;", X, X);
+			break;
+		case 0x0007:
+			//Vy > Vx never holds either, the same as Chip8::SUBN
+			if (X == Y)
+				sprintf(line, "V[0xF] = 0; V[0x%X] = 0;", X);
+			else
+				sprintf(line, "V[0xF] = V[0x%X] > V[0x%X] ? 1 : 0; V[0x%X] = V[0x%X] - V[0x%X];", Y, X, X, Y, X);
+			break;
+		case 0x000E:
+			sprintf(line, "V[0xF] = V[0x%X] %% 2; V[0x%X] <<= 1;", X, X);
+			break;
+		}
+		break;
+
+	case 0x9000:
+		if (X == Y)
+			sprintf(line, "pc = 0x%03X;", next);
+		else
+			sprintf(line, "pc = V[0x%X] != V[0x%X] ? 0x%03X : 0x%03X;", X, Y, skip, next);
+		break;
+
+	case 0xA000:
+		sprintf(line, "I = 0x%03X;", NNN);
+		break;
+
+	case 0xF000:
+		switch (opcode & 0x00FF)
+		{
+		case 0x0007:
+			sprintf(line, "V[0x%X] = DT;", X);
+			break;
+		case 0x0015:
+			sprintf(line, "DT = V[0x%X];", X);
+			break;
+		case 0x0018:
+			sprintf(line, "ST = V[0x%X];", X);
+			break;
+		case 0x001E:
+			sprintf(line, "V[0xF] = I + V[0x%X] > 0xFFF ? 1 : 0; I += V[0x%X];", X, X);
+			break;
+		case 0x0029:
+			sprintf(line, "I = (unsigned short)(V[0x%X] * 5);", X);
+			break;
+		}
+		break;
+	}
+
+	// Everything else runs the interpreter's opcode function
+	if (line[0] == '\0')
+	{
+		executed = true;
+		sprintf(line, "pc = 0x%03X; StaticCode::execute(c, 0x%04X);", address, opcode);
+	}
+
+	return line;
+}
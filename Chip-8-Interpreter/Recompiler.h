@@ -0,0 +1,55 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name: Chip 8 Interpreter
+//
+// Author: Jonathan Del Corpo
+// Contact: jonathan_delcorpo@hotmail.com
+//
+// License: GNU General Public License (GPL) v2 
+// ( http://www.gnu.org/licenses/old-licenses/gpl-2.0.html )
+//
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdio>
+
+//Largest number of opcodes in a recompiled block
+const size_t MAX_STATIC_BLOCK_LENGTH = 64;
+
+//Recompiles a ROM to a C++ file, add the file to the project to run the ROM with CORE_STATIC
+//Usage: -recompile rom output.cpp
+int runRecompiler(int argc, char *argv[]);
+
+class Recompiler
+{
+public:
+	//Straight line run of opcodes found by following the control flow
+	struct Block
+	{
+		unsigned short address;
+		std::vector<unsigned short> opcodes;
+	};
+
+	Recompiler(const std::vector<unsigned char>& rom);
+
+	//Follow every jump, call and skip from 0x200
+	void discover();
+
+	//Write the blocks as a C++ file, name is used for the identifiers of the file
+	bool write(const std::string& path, const std::string& name);
+
+	size_t blockCount() const;
+
+private:
+	std::vector<unsigned char> rom;
+
+	//Blocks by start address
+	std::map<unsigned short, Block> blocks;
+
+	bool inRom(unsigned int address) const;
+
+	unsigned short fetch(unsigned short address) const;
+
+	std::string translate(unsigned short address, unsigned short opcode, bool& executed) const;
+};
@@ -0,0 +1,46 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name: Chip 8 Interpreter
+//
+// Author: Jonathan Del Corpo
+// Contact: jonathan_delcorpo@hotmail.com
+//
+// License: GNU General Public License (GPL) v2 
+// ( http://www.gnu.org/licenses/old-licenses/gpl-2.0.html )
+//
+///////////////////////////////////////////////////////////////////////////////
+#include <thread>
+#include "Scheduler.h"
+
+FrameScheduler::FrameScheduler(double frameTime) :
+	frameTime(std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(frameTime)))
+{
+	start();
+}
+
+void FrameScheduler::start()
+{
+	nextFrame = Clock::now() + frameTime;
+}
+
+void FrameScheduler::waitNextFrame()
+{
+	// Sleeping can overshoot by about a millisecond (SDL sets the Windows timer resolution to 1 ms)
+	const Clock::duration SLEEP_MARGIN = std::chrono::milliseconds(2);
+
+	Clock::time_point now = Clock::now();
+
+	if (now - nextFrame > MAX_LATE_FRAMES * frameTime)
+		nextFrame = now;
+
+	while (now < nextFrame)
+	{
+		if (nextFrame - now > SLEEP_MARGIN)
+			std::this_thread::sleep_for(nextFrame - now - SLEEP_MARGIN);
+		else
+			std::this_thread::yield();
+
+		now = Clock::now();
+	}
+
+	nextFrame += frameTime;
+}
@@ -0,0 +1,36 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name: Chip 8 Interpreter
+//
+// Author: Jonathan Del Corpo
+// Contact: jonathan_delcorpo@hotmail.com
+//
+// License: GNU General Public License (GPL) v2 
+// ( http://www.gnu.org/licenses/old-licenses/gpl-2.0.html )
+//
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <chrono>
+
+//Paces a loop to a fixed frame time
+//Sleeps most of the wait and yields for the last stretch so frames start within a fraction of a millisecond
+class FrameScheduler
+{
+public:
+	//frameTime in milliseconds
+	FrameScheduler(double frameTime);
+
+	//The next frame is due one frame time from now
+	void start();
+
+	//Wait until the next frame is due
+	//A loop that falls more than MAX_LATE_FRAMES behind starts again from now instead of running frames back to back
+	void waitNextFrame();
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	static const int MAX_LATE_FRAMES = 4;
+
+	Clock::duration frameTime;
+	Clock::time_point nextFrame;
+};
@@ -0,0 +1,84 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name: Chip 8 Interpreter
+//
+// Author: Jonathan Del Corpo
+// Contact: jonathan_delcorpo@hotmail.com
+//
+// License: GNU General Public License (GPL) v2 
+// ( http://www.gnu.org/licenses/old-licenses/gpl-2.0.html )
+//
+///////////////////////////////////////////////////////////////////////////////
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(unsigned int threads)
+{
+	if (threads == 0)
+		threads = std::thread::hardware_concurrency();
+	if (threads == 0)
+		threads = 1;
+
+	for (unsigned int i = 0; i < threads; ++i)
+		workers.push_back(std::unique_ptr<Worker>(new Worker));
+}
+
+unsigned int ThreadPool::threadCount() const
+{
+	return (unsigned int)workers.size();
+}
+
+void ThreadPool::run(size_t count, const Job& job)
+{
+	// Deal the jobs out like cards, stealing evens out whatever this gets wrong
+	for (size_t i = 0; i < count; ++i)
+		workers[i % workers.size()]->jobs.push_back(i);
+
+	std::vector<std::thread> threads;
+	for (size_t i = 1; i < workers.size(); ++i)
+		threads.push_back(std::thread(&ThreadPool::work, this, i, std::cref(job)));
+
+	// The calling thread is worker 0
+	work(0, job);
+
+	for (size_t i = 0; i < threads.size(); ++i)
+		threads[i].join();
+}
+
+void ThreadPool::work(size_t self, const Job& job)
+{
+	size_t next;
+
+	// No job adds more jobs, so once every queue is empty the thread is done
+	while (pop(self, next) || steal(self, next))
+		job(next);
+}
+
+bool ThreadPool::pop(size_t self, size_t& next)
+{
+	Worker& worker = *workers[self];
+	std::lock_guard<std::mutex> guard(worker.lock);
+
+	if (worker.jobs.empty())
+		return false;
+
+	next = worker.jobs.back();
+	worker.jobs.pop_back();
+	return true;
+}
+
+bool ThreadPool::steal(size_t self, size_t& next)
+{
+	for (size_t i = 1; i < workers.size(); ++i)
+	{
+		Worker& victim = *workers[(self + i) % workers.size()];
+		std::lock_guard<std::mutex> guard(victim.lock);
+
+		if (victim.jobs.empty())
+			continue;
+
+		next = victim.jobs.front();
+		victim.jobs.pop_front();
+		return true;
+	}
+
+	return false;
+}
@@ -0,0 +1,50 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name: Chip 8 Interpreter
+//
+// Author: Jonathan Del Corpo
+// Contact: jonathan_delcorpo@hotmail.com
+//
+// License: GNU General Public License (GPL) v2 
+// ( http://www.gnu.org/licenses/old-licenses/gpl-2.0.html )
+//
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <deque>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <functional>
+
+//Runs numbered jobs on several threads, every thread has its own queue and takes jobs
+//from the other queues once its own is empty so long jobs don't leave threads idle
+class ThreadPool
+{
+public:
+	typedef std::function<void(size_t job)> Job;
+
+	//0 uses one thread per hardware thread
+	ThreadPool(unsigned int threads = 0);
+
+	//Calls job(0) to job(count - 1) and returns once every call returned
+	void run(size_t count, const Job& job);
+
+	unsigned int threadCount() const;
+
+private:
+	struct Worker
+	{
+		std::mutex lock;
+		std::deque<size_t> jobs;
+	};
+
+	std::vector<std::unique_ptr<Worker>> workers;
+
+	void work(size_t self, const Job& job);
+
+	//Newest job of the thread's own queue
+	bool pop(size_t self, size_t& next);
+
+	//Oldest job of another thread's queue
+	bool steal(size_t self, size_t& next);
+};
@@ -0,0 +1,56 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name: Chip 8 Interpreter
+//
+// Author: Jonathan Del Corpo
+// Contact: jonathan_delcorpo@hotmail.com
+//
+// License: GNU General Public License (GPL) v2 
+// ( http://www.gnu.org/licenses/old-licenses/gpl-2.0.html )
+//
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <atomic>
+
+//Hands the latest value from one writer thread to one reader thread without locks
+//The writer fills writeBuffer and publishes it, the reader picks up the newest published value with update.
+//Values published while the reader didn't call update are dropped, neither side ever waits for the other.
+template <class T>
+class TripleBuffer
+{
+public:
+	TripleBuffer() : middle(1), reading(0), writing(2) {}
+
+	//Only used by the writer
+	T& writeBuffer() { return buffers[writing]; }
+
+	//Make writeBuffer the newest value and start writing to another buffer
+	void publish()
+	{
+		writing = middle.exchange(writing | FRESH, std::memory_order_acq_rel) & INDEX;
+	}
+
+	//Swap in the newest value if one was published since the last call, only used by the reader
+	bool update()
+	{
+		if ((middle.load(std::memory_order_relaxed) & FRESH) == 0)
+			return false;
+
+		reading = middle.exchange(reading, std::memory_order_acq_rel) & INDEX;
+		return true;
+	}
+
+	//Only used by the reader
+	const T& readBuffer() const { return buffers[reading]; }
+
+private:
+	static const unsigned int INDEX = 0x3;
+	static const unsigned int FRESH = 0x4;	//set while middle holds a value the reader hasn't seen
+
+	T buffers[3];
+
+	//Buffer between the two threads, with the FRESH bit
+	std::atomic<unsigned int> middle;
+
+	unsigned int reading;
+	unsigned int writing;
+};
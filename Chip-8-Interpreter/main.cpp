@@ -12,31 +12,113 @@
 
 int main(int argc, char *argv[])
 {
-	//Set up the render system and register input callbacks
-	setupGraphics();
-	
+	//Headless benchmark of the CPU cores, no window is created
+	if (argc > 1 && std::string(argv[1]) == "-bench")
+		return runBenchmark(argc - 2, argv + 2);
+
+	//Run many ROMs headless on every hardware thread
+	if (argc > 1 && std::string(argv[1]) == "-batch")
+		return runBatch(argc - 2, argv + 2);
+
+	//Check every core ends each frame in the same state as the switch core
+	if (argc > 1 && std::string(argv[1]) == "-conformance")
+		return runConformance(argc - 2, argv + 2);
+
+	//Recompile a ROM to C++ and exit
+	if (argc > 1 && std::string(argv[1]) == "-recompile")
+		return runRecompiler(argc - 2, argv + 2);
+
+	//Dump the last opcodes executed if the emulator crashes
+	std::signal(SIGSEGV, crashHandler);
+	std::signal(SIGABRT, crashHandler);
+	std::signal(SIGFPE, crashHandler);
+	std::signal(SIGILL, crashHandler);
+
+	if (argc < 2)
+	{
+		printf("%s", USAGE);
+		return 1;
+	}
+
 	//Initialize the Chip8 system and load the game into memory
 	myChip8.initialize();
-	myChip8.loadGame(std::string(argv[1]));
+	Chip8::LoadResult loaded = myChip8.loadGame(std::string(argv[1]));
+	if (loaded != Chip8::LOAD_OK)
+	{
+		printf("%s: %s\n", argv[1], Chip8::describeLoadResult(loaded));
+		return 1;
+	}
 
-	//Emulation loop
-	for (;;)
+	for (int i = 2; i < argc; i++)
 	{
-		//emulate one cycle
-		myChip8.executeCycle();
+		std::string arg(argv[i]);
 
-		//If the draw flag is set, update the screen
-		//opcodes to clear screen:
-		//0x00E0 - Clears the screen
-		//0xDXYN - Draws a sprite on the screen
-		drawGraphics();
+		//Instructions per 60 Hz frame, the speed of the game
+		if (arg == "-ipf" && i + 1 < argc)
+		{
+			unsigned int cycles;
+			if (!parseNumber(argv[++i], cycles))
+			{
+				printf("%s", USAGE);
+				return 1;
+			}
+			myChip8.setCyclesPerFrame(cycles);
+		}
+
+		//Fast forward the whole game instead of only while Tab is held
+		else if (arg == "-turbo")
+			turboLocked = turbo = true;
+
+		//Frames emulated per frame drawn in turbo mode
+		else if (arg == "-frameskip" && i + 1 < argc)
+		{
+			unsigned int skip;
+			if (!parseNumber(argv[++i], skip) || skip > INT_MAX)
+			{
+				printf("%s", USAGE);
+				return 1;
+			}
+			turboFrameSkip = std::max(1, (int)skip);
+		}
+
+		//Keyboard layout file, see keys.cfg
+		else if (arg == "-keys" && i + 1 < argc)
+		{
+			keyMapPath = argv[++i];
+			if (!keyMap.load(keyMapPath))
+				printf("Invalid key map %s, using the default keys\n", keyMapPath.c_str());
+		}
+	}
+
+	//keys.cfg in the working directory replaces the default keys when present
+	if (keyMapPath.empty())
+		keyMap.load(DEFAULT_KEY_MAP);
 
+	//Set up the render system and register input callbacks, once the arguments are known to be valid
+	setupGraphics();
+
+	//The emulator runs on its own thread, this one draws the frames it publishes and handles events
+	std::thread emulation(runEmulation);
+
+	for (;;)
+	{
 		//Store key press  state (Press and Release)
 		//If the function returns true, that means the user requested to close the application
 		if (setEvents())
 			break;
+
+		//Draw the newest frame if the screen changed, presenting waits for the display refresh
+		if (frames.update())
+			drawGraphics(frames.readBuffer());
+		else
+			SDL_Delay(1);
 	}
 
+	running = false;
+	wakeEmulation();
+	emulation.join();
+
+	SDL_DestroyTexture(texture);
 	SDL_DestroyRenderer(renderer);
 	SDL_DestroyWindow(window);
 	SDL_Quit();
@@ -56,25 +138,23 @@ void setupGraphics()
 		DEFAULT_WINDOW_HEIGHT,
 		SDL_WINDOW_RESIZABLE);
 
-	getWindowSize();
-	getScale();
-
 	renderer = SDL_CreateRenderer(
 		window,
 		-1,
 		SDL_RENDERER_ACCELERATED |
+		SDL_RENDERER_PRESENTVSYNC |
 		SDL_RENDERER_TARGETTEXTURE);
-}
 
-void getWindowSize()
-{
-	SDL_GetWindowSize(window, &windowSize.w, &windowSize.h);
-}
+	// Nearest pixel scaling keeps the pixels square and sharp
+	SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "0");
 
-void getScale()
-{
-	scaleX = ((float)windowSize.w / 64.0f);
-	scaleY = ((float)windowSize.h / 32.0f);
+	// One texel per Chip8 pixel, stretched over the whole window when drawn
+	texture = SDL_CreateTexture(
+		renderer,
+		SDL_PIXELFORMAT_ARGB8888,
+		SDL_TEXTUREACCESS_STREAMING,
+		SCREEN_WIDTH,
+		SCREEN_HEIGHT);
 }
 
 
@@ -111,131 +191,195 @@ void windowEvent(SDL_Event& e)
 {
 	switch (e.window.event)
 	{
+	// Nothing is presented while the game doesn't draw, so the window has to be redrawn here
+	case SDL_WINDOWEVENT_EXPOSED:
 	case SDL_WINDOWEVENT_SIZE_CHANGED:
-		getWindowSize();
-		getScale();
+		presentGraphics();
 		break;
 	}
 }
 
 void keyDown(SDL_Event& e)
 {
+	//F12 prints the last opcodes executed, from the emulation thread
+	if (e.key.keysym.sym == SDLK_F12)
+	{
+		dumpRequested = true;
+		wakeEmulation();
+	}
+
+	//Fast forward while Tab is held
+	if (e.key.keysym.sym == SDLK_TAB)
+		turbo = true;
+
 	handleKeys(e, 1);
 }
 
 void keyUp(SDL_Event& e)
 {
+	if (e.key.keysym.sym == SDLK_TAB)
+		turbo = turboLocked;
+
 	handleKeys(e, 0);
 }
 
 void handleKeys(SDL_Event& e, char value)
 {
-	switch (e.key.keysym.sym)
-	{
+	unsigned char key = keyMap.lookup(e.key.keysym.scancode);
+	if (key != KeyMap::NO_KEY)
+		setKey(key, value);
+}
 
-		//1
-	case SDLK_1:
-		myChip8.key[1] = value;
-		break;
-	
-		//2
-	case SDLK_2:
-		myChip8.key[2] = value;
-		break;
+void setKey(int key, char value)
+{
+	if (value)
+		keyState |= 1 << key;
+	else
+		keyState &= ~(1 << key);
 
-		//3
-	case SDLK_3:
-		myChip8.key[3] = value;
-		break;
+	//Releases wake it too, waitForKey waits for any change
+	wakeEmulation();
+}
 
-		//C
-	case SDLK_4:
-		myChip8.key[0xC] = value;
-		break;
+//Wake the emulation thread if it sleeps in waitForKey
+//Taking the lock makes sure it isn't between checking the keys and going to sleep
+void wakeEmulation()
+{
+	std::lock_guard<std::mutex> lock(keyMutex);
+	keyChanged.notify_one();
+}
 
-		//4
-	case SDLK_q:
-		myChip8.key[4] = value;
-		break;
+//Sleep until the keys differ from the ones the last frame ran with, the window is closed or a trace dump is requested
+//Waiting for a change rather than any key keeps a key Fx0A ignores (held since before the wait) from waking it every time
+void waitForKey(unsigned int seen)
+{
+	std::unique_lock<std::mutex> lock(keyMutex);
+	keyChanged.wait(lock, [seen] { return keyState != seen || !running || dumpRequested; });
+}
 
-		//5
-	case SDLK_w:
-		myChip8.key[5] = value;
-		break;
+//Emulation thread, runs 60 frames per second and publishes a frame whenever the screen changed
+//In turbo mode it runs frames as fast as it can and only publishes every turboFrameSkip frames.
+//The timers still tick once per emulated frame so games that wait on them behave the same, just faster.
+void runEmulation()
+{
+	FrameScheduler scheduler(FRAME_RATE);
+	int skipped = 0;
+	bool wasTurbo = false;
 
-		//6
-	case SDLK_e:
-		myChip8.key[6] = value;
-		break;
+	while (running)
+	{
+		//Keys pressed on the main thread since the last frame
+		unsigned int keys = keyState;
+		for (int i = 0; i < 16; i++)
+			myChip8.key[i] = (keys >> i) & 1;
 
-		//D
-	case SDLK_r:
-		myChip8.key[0xD] = value;
-		break;
+		//emulate one frame worth of cycles
+		myChip8.runFrame();
 
-		//7
-	case SDLK_a:
-		myChip8.key[7] = value;
-		break;
+		if (dumpRequested.exchange(false))
+			myChip8.dumpTrace(stdout);
 
-		//8
-	case SDLK_s:
-		myChip8.key[8] = value;
-		break;
+		bool fast = turbo;
+		bool show = !fast || ++skipped >= turboFrameSkip;
+		if (show)
+			skipped = 0;
 
-		//9
-	case SDLK_d:
-		myChip8.key[9] = value;
-		break;
+		//If the draw flag is set, hand the screen to the main thread
+		//Skipped frames leave the flag set so the rows they changed are published with the next shown frame
+		//opcodes that set it:
+		//0x00E0 - Clears the screen
+		//0xDXYN - Draws a sprite on the screen
+		//A game waiting for a key shows its last frame even in turbo mode
+		bool waiting = myChip8.isWaitingForKey();
+		if ((show || waiting) && myChip8.takeDirtyRows() != 0)
+		{
+			memcpy(frames.writeBuffer().gfx, myChip8.gfx, sizeof(myChip8.gfx));
+			frames.publish();
+		}
 
-		//E
-	case SDLK_f:
-		myChip8.key[0xE] = value;
-		break;
+		//Fx0A with the timers stopped: running more frames changes nothing, sleep until a key is pressed
+		if (waiting)
+		{
+			waitForKey(keys);
+			scheduler.start();
+			wasTurbo = fast;
+			continue;
+		}
 
-		//A
-	case SDLK_z:
-		myChip8.key[0xA] = value;
-		break;
+		//Sleep for the rest of the frame, counting from now once turbo mode ends
+		if (!fast)
+		{
+			if (wasTurbo)
+				scheduler.start();
+			else
+				scheduler.waitNextFrame();
+		}
+		wasTurbo = fast;
+	}
+}
 
-		//0
-	case SDLK_x:
-		myChip8.key[0] = value;
-		break;
+void drawGraphics(const Frame& frame)
+{
+	// Frames can be skipped, so the changed rows are found by comparing with the last frame drawn
+	int first = 0;
+	int last = -1;
+	for (int i = 0; i < (int)SCREEN_HEIGHT; i++)
+	{
+		if (!textureEmpty && memcmp(frame.gfx[i], shownFrame.gfx[i], sizeof(frame.gfx[i])) == 0)
+			continue;
 
-		//B
-	case SDLK_c:
-		myChip8.key[0xB] = value;
-		break;
+		if (last < 0)
+			first = i;
+		last = i;
+	}
 
-		//F
-	case SDLK_v:
-		myChip8.key[0xF] = value;
-		break;
+	if (last < 0)
+		return;
+
+	// Only the rows from the first to the last changed one are uploaded
+	SDL_Rect area = { 0, first, SCREEN_WIDTH, last - first + 1 };
+
+	void *pixels;
+	int pitch;
+	if (SDL_LockTexture(texture, &area, &pixels, &pitch) != 0)
+		return;
+
+	// Expand every bit of the screen rows to a white or black texel
+	for (int i = first; i <= last; i++)
+	{
+		Uint32 *row = (Uint32 *)((Uint8 *)pixels + (i - first) * pitch);
+		for (unsigned int j = 0; j < SCREEN_WIDTH; j++)
+			row[j] = getScreenPixel(frame.gfx[i], j) != 0 ? 0xFFFFFFFF : 0xFF000000;
 	}
-}
 
+	SDL_UnlockTexture(texture);
+
+	shownFrame = frame;
+	textureEmpty = false;
+
+	presentGraphics();
+}
 
+//Show the texture again without uploading anything
+void presentGraphics()
+{
+	// The whole screen in one draw call, scaled to the window
+	SDL_RenderCopy(renderer, texture, NULL, NULL);
+	SDL_RenderPresent(renderer);
+}
 
-void drawGraphics()
+//Only async signal safe calls here, stdio or the heap may be what crashed
+//The dump is best effort: the emulation thread can still be running and writing the trace
+void crashHandler(int signal)
 {
-	
-	for (int i = 0; i < 32; i++)
 	{
-		for (int j = 0; j < 64; j++)
-		{
-			if(myChip8.gfx[i][j] != 0)
-				SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
-			else
-				SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
-
-			SDL_Rect rect;
-			rect.x = (float)j * scaleX;
-			rect.y = (float)i * scaleY;
-			rect.w = scaleX;
-			rect.h = scaleY;
-			SDL_RenderFillRect(renderer, &rect);
-		}
+		SignalSafeWriter out(2);
+		out.text("Crashed with signal ");
+		out.decimal(signal);
+		out.text("\n");
 	}
-	SDL_RenderPresent(renderer);
+	myChip8.writeTrace(2);
+
+	std::signal(signal, SIG_DFL);
+	std::raise(signal);
 }
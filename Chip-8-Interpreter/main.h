@@ -10,31 +10,83 @@
 ///////////////////////////////////////////////////////////////////////////////
 #pragma once
 #include <vector>
+#include <algorithm>
 #include <math.h>
+#include <csignal>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
 #include <SDL.h>
 #include "Chip8.h"
+#include "Arguments.h"
+#include "Benchmark.h"
+#include "Batch.h"
+#include "Conformance.h"
+#include "Recompiler.h"
+#include "TripleBuffer.h"
+#include "Scheduler.h"
+#include "KeyMap.h"
 
 Chip8 myChip8;
-SDL_Rect windowSize;
 SDL_Window * window = NULL;
 SDL_Renderer * renderer = NULL;
+SDL_Texture * texture = NULL;
 SDL_Event event;
 
+//Screen handed from the emulation thread to the main thread
+struct Frame
+{
+	unsigned long long gfx[SCREEN_HEIGHT][SCREEN_ROW_WORDS];
+};
+
+TripleBuffer<Frame> frames;
+
+//Last frame uploaded to the texture, nothing is uploaded yet while textureEmpty is set
+Frame shownFrame;
+bool textureEmpty = true;
+
+//Shared between the main thread and the emulation thread
+std::atomic<unsigned int> keyState(0);		//bit n is set while key n is pressed
+std::atomic<bool> dumpRequested(false);
+std::atomic<bool> running(true);
+std::atomic<bool> turbo(false);
+
+//Signalled when a key is pressed, the emulation thread sleeps on it while the game waits for a key
+std::mutex keyMutex;
+std::condition_variable keyChanged;
+
+//Turbo mode stays on when started with -turbo
+bool turboLocked = false;
+
+//Frames emulated per frame drawn in turbo mode
+const int DEFAULT_TURBO_FRAME_SKIP = 10;
+int turboFrameSkip = DEFAULT_TURBO_FRAME_SKIP;
+
+//SDL scancode to Chip8 key table, loaded from -keys or DEFAULT_KEY_MAP
+KeyMap keyMap;
+std::string keyMapPath;
+const char DEFAULT_KEY_MAP[] = "keys.cfg";
+
+const char USAGE[] = "Usage: Chip-8-Interpreter.exe GameName [-ipf N] [-turbo] [-frameskip N] [-keys file]\n";
+
 const int DEFAULT_WINDOW_WIDTH = 512;
 const int DEFAULT_WINDOW_HEIGHT = 256;
 
+//Milliseconds per frame
 const float FRAME_RATE = 1000.0f / 60.0f;
 
-float scaleX;
-float scaleY;
-
-void drawGraphics();
+void drawGraphics(const Frame& frame);
+void presentGraphics();
 void setupGraphics();
-void getWindowSize();
-void getScale();
 bool setEvents();
 void windowEvent(SDL_Event& e);
 void keyDown(SDL_Event& e);
 void keyUp(SDL_Event& e);
 void handleKeys(SDL_Event& e, char value);
+void setKey(int key, char value);
+void wakeEmulation();
+void waitForKey(unsigned int seen);
+void runEmulation();
+void crashHandler(int signal);
 